@@ -0,0 +1,126 @@
+/*
+ * Checkpoint.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <boost/log/trivial.hpp>
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "Interpreter.h"
+#include "EventService.h"
+#include "ThreadMgr.h"
+#include "LockMgr.h"
+#include "Tool.h"
+
+ShadowThread* ShadowIndex::thread(ShadowThread::ThreadId id) const {
+
+	auto search = threads.find(id);
+	return search != threads.end() ? search->second : nullptr;
+}
+
+ShadowLock* ShadowIndex::lock(ShadowLock::LockId id) const {
+
+	auto search = locks.find(id);
+	return search != locks.end() ? search->second : nullptr;
+}
+
+Checkpoint::Checkpoint(const char *path,
+					   unsigned interval,
+					   EventService *service,
+					   ThreadMgr *threadMgr,
+					   LockMgr *lockMgr)
+	: path_(path), interval_(interval > 0 ? interval : 1), processed_(0),
+	  service_(service), threadMgr_(threadMgr), lockMgr_(lockMgr) {}
+
+int Checkpoint::save(INS_ID lastInstruction) {
+
+	service_->flush();	// the tools' state must include every event
+
+	rapidjson::Document doc;
+	doc.SetObject();
+	rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+
+	rapidjson::Value threads, locks;
+	threadMgr_->serialize(threads, allocator);
+	lockMgr_->serialize(locks, allocator);
+
+	rapidjson::Value tools(rapidjson::kArrayType);
+	for (auto tool : service_->getTools()) {
+		rapidjson::Value state(rapidjson::kObjectType);
+		tool->serialize(state, allocator);
+		tools.PushBack(state, allocator);
+	}
+
+	doc.AddMember("version", VERSION, allocator);
+	doc.AddMember("instruction", lastInstruction, allocator);
+	doc.AddMember("threads", threads, allocator);
+	doc.AddMember("locks", locks, allocator);
+	doc.AddMember("tools", tools, allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	// write aside and rename, so a crash never leaves a partial checkpoint
+	std::string tmpPath = path_ + ".tmp";
+	std::ofstream file(tmpPath.c_str(), std::ios::trunc);
+	file << buffer.GetString();
+	file.close();
+	if (file.fail() || std::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+		BOOST_LOG_TRIVIAL(error) << "Can't write checkpoint " << path_;
+		return IN_ABORT;
+	}
+
+	BOOST_LOG_TRIVIAL(trace) << "Checkpoint after instruction " << lastInstruction;
+	return IN_OK;
+}
+
+int Checkpoint::restore(INS_ID *lastInstruction) {
+
+	std::ifstream file(path_.c_str());
+	if (!file) {
+		BOOST_LOG_TRIVIAL(warning) << "No checkpoint " << path_ << ", starting over";
+		return IN_NO_ENTRY;
+	}
+	std::stringstream content;
+	content << file.rdbuf();
+
+	rapidjson::Document doc;
+	doc.Parse(content.str().c_str());
+	if (doc.HasParseError() || !doc.IsObject() ||
+		!doc.HasMember("version") || !doc["version"].IsUint() ||
+		doc["version"].GetUint() != VERSION ||
+		!doc.HasMember("instruction") || !doc["instruction"].IsUint64() ||
+		!hasArray(doc, "tools") ||
+		doc["tools"].Size() != service_->getTools().size()) {
+		BOOST_LOG_TRIVIAL(fatal) << path_ << " is no checkpoint of this setup";
+		return IN_ABORT;
+	}
+
+	ShadowIndex index;
+	if (!doc.HasMember("threads") || !threadMgr_->restore(doc["threads"], &index) ||
+		!doc.HasMember("locks") || !lockMgr_->restore(doc["locks"], &index)) {
+		BOOST_LOG_TRIVIAL(fatal) << path_ << " has malformed thread or lock state";
+		return IN_ABORT;
+	}
+
+	const rapidjson::Value& tools = doc["tools"];
+	rapidjson::SizeType i = 0;
+	for (auto tool : service_->getTools()) {
+		if (!tool->restore(tools[i++], index)) {
+			BOOST_LOG_TRIVIAL(fatal) << path_ << " has malformed state of tool "
+									 << i - 1;
+			return IN_ABORT;
+		}
+	}
+
+	*lastInstruction = doc["instruction"].GetUint64();
+	BOOST_LOG_TRIVIAL(trace) << "Resuming after instruction " << *lastInstruction;
+	return IN_OK;
+}
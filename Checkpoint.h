@@ -0,0 +1,84 @@
+/*
+ * Checkpoint.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <map>
+#include <string>
+#include "rapidjson/document.h"
+#include "DBDataModel.h"
+#include "ShadowThread.h"
+#include "ShadowLock.h"
+
+class EventService;
+class LockMgr;
+class ThreadMgr;
+
+/******************************************************************************
+ * ShadowIndex
+ *
+ * Shadow threads and locks of a restored checkpoint by their id, so tools
+ * can turn serialized ids back into the entities the managers hand out.
+ *****************************************************************************/
+struct ShadowIndex {
+	std::map<ShadowThread::ThreadId, ShadowThread*> threads;
+	std::map<ShadowLock::LockId, ShadowLock*> locks;
+
+	ShadowThread* thread(ShadowThread::ThreadId id) const;	// nullptr if unknown
+	ShadowLock* lock(ShadowLock::LockId id) const;			// nullptr if unknown
+};
+
+/******************************************************************************
+ * Checkpoint
+ *
+ * Periodically saves the interpretation state: the last processed
+ * instruction, the thread and lock managers and every subscribed tool (in
+ * subscription order). The file is replaced atomically, so it always holds
+ * the latest complete checkpoint.
+ *****************************************************************************/
+class Checkpoint {
+public:
+	static const unsigned VERSION = 1;
+
+	Checkpoint(const char *path, unsigned interval, EventService *service,
+			   ThreadMgr *threadMgr, LockMgr *lockMgr);
+
+	// restore the saved state; IN_NO_ENTRY if there is no checkpoint yet
+	int restore(INS_ID *lastInstruction);
+
+	// count a processed instruction and save every interval instructions
+	void instructionDone(INS_ID instruction) {
+		if (++processed_ % interval_ == 0)
+			save(instruction);
+	}
+
+	int save(INS_ID lastInstruction);
+
+	// shape checks for the restore functions, which return false on
+	// malformed state instead of reading members that are not there
+	static bool hasArray(const rapidjson::Value& state, const char *name) {
+		return state.IsObject() && state.HasMember(name) &&
+			   state[name].IsArray();
+	}
+	static bool isTuple(const rapidjson::Value& value, rapidjson::SizeType size) {
+		return value.IsArray() && value.Size() == size;
+	}
+
+private:
+	const std::string path_;
+	const unsigned interval_;
+	unsigned long processed_;
+	EventService *service_;
+	ThreadMgr *threadMgr_;
+	LockMgr *lockMgr_;
+
+	// prevent generated functions
+	Checkpoint(const Checkpoint&);
+	Checkpoint& operator=(const Checkpoint&);
+};
+
+#endif /* CHECKPOINT_H_ */
@@ -12,29 +12,33 @@
 #include <string>
 #include "DataModel.h"
 
+class ShadowThread;
+class ShadowVar;
+class ShadowLock;
+
 // constants---------------------------------------------------------------
-static const unsigned ITYPELEN = 10;
 static const unsigned TIMELEN = 12;
-static const unsigned CALLIDLEN = 50;
-static const unsigned REFIDLEN = 100;
-static const unsigned MEMSTATELEN = 10;
-static const unsigned FILENAMELEN = 256;
-static const unsigned FILEPATHLEN = 1024;
-static const unsigned SIGNATURELEN = 10000;
-static const unsigned FNTYPELEN = 20;
-static const unsigned REFNAMELEN = 2000;
 static const unsigned SEGTYPELEN = 2;
+// unresolved ids: NO_ID for trace ids (see TraceId), NO_ID32 for call,
+// function, file and thread ids
+static const TraceId NO_ID = static_cast<TraceId>(-1);
+static const unsigned NO_ID32 = static_cast<unsigned>(-1);
+
+// Variable-length text columns are not copied into the rows. Rows keep
+// views into a StringArena owned by their table (or into the SQLite row
+// buffer while streaming) that outlive the row.
 
 // types-------------------------------------------------------------------
-typedef unsigned 		INS_ID;		// instruction id
-typedef unsigned 		SEG_ID;		// segment id
-typedef unsigned 		ACC_ID;		// access id
-typedef unsigned		REF_ID;		// reference id
-typedef std::string 	CAL_ID;		// call id
+typedef TraceId 		INS_ID;		// instruction id
+typedef TraceId 		SEG_ID;		// segment id
+typedef TraceId 		ACC_ID;		// access id
+typedef TraceId			REF_ID;		// reference id
+typedef unsigned 		CAL_ID;		// call id (assigned at load time)
+typedef const char* 	CAL_NO;		// call no
 typedef unsigned		FUN_ID;		// function id
 typedef unsigned 		FIL_ID;		// file id
-typedef std::string		REF_NO;		// reference no
-typedef int				REF_ADDR;	// reference address
+typedef const char*		REF_NO;		// reference no
+typedef MemAddress		REF_ADDR;	// reference address
 typedef unsigned		REF_SIZE;	// reference size
 typedef std::string		REF_NAME;	// reference name
 typedef char			REF_MTYP;	// memory type
@@ -44,23 +48,24 @@ typedef unsigned		TRD_ID;		// thread id (table)
 typedef unsigned		TRD_TID;	// thread id (system)
 
 typedef struct access_t {
+	ACC_ID id;
 	INS_ID instruction_id;
 	int position;
-	char reference_id[REFIDLEN];
-	ACC_TYP access_type;
-	char memory_state[MEMSTATELEN];
+	REF_NO reference_no;
+	REF_ID reference_id;	// resolved from reference_no
+	Access::type access_type;
+	const char *memory_state;
 
-	access_t(int instructionID,
+	access_t(ACC_ID accessID,
+			 INS_ID instructionID,
 			 int pos,
-			 const unsigned char *referenceID,
-			 const unsigned char *accessType,
-			 const unsigned char *memoryState)
-		: instruction_id(instructionID), position(pos),
-		  access_type(*accessType)
-	{
-		strncpy(reference_id, (const char*)referenceID, REFIDLEN);
-		strncpy(memory_state, (const char*)memoryState, MEMSTATELEN);
-	}
+			 REF_NO referenceNo,
+			 const char *accessType,
+			 const char *memoryState)
+		: id(accessID), instruction_id(instructionID), position(pos),
+		  reference_no(referenceNo), reference_id(NO_ID),
+		  access_type(getAccessType(*accessType)),
+		  memory_state(memoryState) {}
 
 	static Access::type getAccessType(ACC_TYP accType) {
 		switch (accType) {
@@ -81,15 +86,17 @@ typedef struct call_t {
 	INS_ID instruction_id;
 	char start_time[TIMELEN];
 	char end_time[TIMELEN];
+	ShadowThread *thread;	// linked after loading
 
 	call_t(int processID,
 		   int threadID,
 		   int functionID,
-		   int instructionID,
+		   INS_ID instructionID,
 		   const unsigned char *startTime,
 		   const unsigned char *endTime)
 		: process_id(processID), thread_id(threadID),
-		  function_id(functionID), instruction_id(instructionID)
+		  function_id(functionID), instruction_id(instructionID),
+		  thread(nullptr)
 	{
 		strncpy(start_time, (const char*)startTime, TIMELEN);
 		strncpy(end_time, (const char*)endTime, TIMELEN);
@@ -97,30 +104,25 @@ typedef struct call_t {
 } call_t;
 
 typedef struct file_t {
-	char file_name[FILENAMELEN], file_path[FILEPATHLEN];
+	const char *file_name, *file_path;
 
-	file_t(const unsigned char *fileName,
-		   const unsigned char *filePath)
-	{
-		strncpy(file_name, (const char*)fileName, FILENAMELEN);
-		strncpy(file_path, (const char*)filePath, FILEPATHLEN);
-	}
+	file_t(const char *fileName,
+		   const char *filePath)
+		: file_name(fileName), file_path(filePath) {}
 } file_t;
 
 typedef struct function_t {
-	char signature[SIGNATURELEN], type[FNTYPELEN];
+	const char *signature;
+	Function::type type;
 	FIL_ID file_id;
 
-	function_t(const unsigned char *fnSignature,
-			   const unsigned char *fnType,
+	function_t(const char *fnSignature,
+			   const char *fnType,
 			   int fileId)
-		: file_id(fileId)
-	{
-		strncpy(signature, (const char*)fnSignature, SIGNATURELEN);
-		strncpy(type, (const char*)fnType, FNTYPELEN);
-	}
+		: signature(fnSignature), type(getFunctionType(fnType)),
+		  file_id(fileId) {}
 
-	static Function::type getFunctionType(const FUN_TYP fnType) {
+	static Function::type getFunctionType(const char* fnType) {
 		if (strcmp( fnType, "METHOD") == 0)
 			return Function::METHOD;
 		else if (strcmp( fnType, "FUNCTION") == 0)
@@ -146,28 +148,28 @@ typedef struct instruction_t {
 
 	INS_ID instruction_id;
 	SEG_ID segment_id;
-	char instruction_type[ITYPELEN];
+	Instruction::type instruction_type;
 	int line_number;
 
 	instruction_t(INS_ID instructionId,
-				  int segmentId,
-				  const unsigned char *instructionType,
+				  SEG_ID segmentId,
+				  const char *instructionType,
 				  int lineNumber) 
 				  : instruction_id(instructionId), segment_id(segmentId),
-					line_number(lineNumber)
-	{
-		strncpy(instruction_type, (const char*)instructionType, ITYPELEN);
-	}
+					instruction_type(getInstructionType(instructionType)),
+					line_number(lineNumber) {}
 
-	static Instruction::type getInstructionType(FUN_TYP fnType) {
-		if (strcmp( fnType, "CALL") == 0)
+	static Instruction::type getInstructionType(const char* insType) {
+		if (strcmp( insType, "CALL") == 0)
 			return Instruction::CALL;
-		else if (strcmp( fnType, "ACCESS" ) == 0)
+		else if (strcmp( insType, "ACCESS" ) == 0)
 			return Instruction::MEMACCESS;
-		else if (strcmp( fnType, "CSENTER" ) == 0)
+		else if (strcmp( insType, "CSENTER" ) == 0)
 			return Instruction::ACQUIRE;
-		else if (strcmp( fnType, "CSLEAVE" ) == 0)
+		else if (strcmp( insType, "CSLEAVE" ) == 0)
 			return Instruction::RELEASE;
+		else if (strcmp( insType, "THRCREATE" ) == 0)
+			return Instruction::FORK;
 		else
 			return Instruction::OTHER;
 	}
@@ -180,42 +182,42 @@ typedef struct reference_t {
 	static const REF_MTYP GLOBAL = 'G';
 	static const REF_MTYP LOCAL = 'L';
 
-	char reference_id[REFIDLEN];
+	REF_NO reference_no;
 	REF_ID id;
 	//REF_ADDR address;
 	REF_SIZE size;
 	REF_MTYP memory_type;
-	char name[REFNAMELEN];
-	int allocinstr;
+	const char *name;
+	INS_ID allocinstr;
+	ShadowVar *var;		// linked after loading (memory accesses)
+	ShadowLock *lock;	// linked after loading (acquire/release)
 
-	reference_t(const unsigned char *referenceId,
-				int refId,
+	reference_t(REF_NO referenceNo,
+				REF_ID refId,
 				//int refAddr,
 				int refSize,
-				const unsigned char *memoryType,
-				const unsigned char *refName,
-				int allocInstr)
-		: id(refId), /*address(refAddr),*/ size(refSize), memory_type(*memoryType),
-		  allocinstr(allocInstr)
-	{
-		strncpy(reference_id, (const char*)referenceId, REFIDLEN);
-		strncpy(name, (const char*)refName, REFNAMELEN);
-	}
+				const char *memoryType,
+				const char *refName,
+				INS_ID allocInstr)
+		: reference_no(referenceNo), id(refId), /*address(refAddr),*/
+		  size(refSize), memory_type(*memoryType), name(refName),
+		  allocinstr(allocInstr), var(nullptr), lock(nullptr) {}
 
 } reference_t;
 
 typedef struct segment_t {
 
-	std::string call_id;
+	CAL_NO call_no;
+	CAL_ID call_id;		// resolved from call_no
 	int segment_no;
 	char segment_type[SEGTYPELEN];
 	int loop_pointer;
 
-	segment_t(const unsigned char *callId,
+	segment_t(CAL_NO callNo,
 			int segmentNo,
 			const unsigned char *segmentType,
 			int loopPointer)
-		: call_id((const char*)callId), segment_no(segmentNo),
+		: call_no(callNo), call_id(NO_ID32), segment_no(segmentNo),
 		  loop_pointer(loopPointer)
 	{
 		strncpy(segment_type, (const char*)segmentType, SEGTYPELEN);
@@ -229,13 +231,15 @@ typedef struct thread_t {
 	INS_ID instruction_id;
 	TRD_TID parent_thread_id;
 	TRD_TID	child_thread_id;
+	ShadowThread *child_thread;	// linked after loading
 
 	thread_t(int id,
-			 int instructionID,
+			 INS_ID instructionID,
 			 int parentThreadId,
 			 int childThreadId)
 		: id(id), instruction_id(instructionID), 
-		parent_thread_id(parentThreadId), child_thread_id(childThreadId) {}
+		parent_thread_id(parentThreadId), child_thread_id(childThreadId),
+		child_thread(nullptr) {}
 
 } thread_t;
 
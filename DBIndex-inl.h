@@ -0,0 +1,113 @@
+#include "Interpreter.h"
+#include <algorithm>
+#include <utility>
+#include <iterator>
+
+template<typename IdT, typename T>
+DBIndex<IdT, T>::DBIndex() {}
+
+template<typename IdT, typename T>
+DBIndex<IdT, T>::~DBIndex() { }
+
+template<typename IdT, typename T>
+int DBIndex<IdT, T>::fill(const IdT& id, const T& entry) {
+
+	return emplace(id, entry);
+}
+
+template<typename IdT, typename T>
+template<typename... Args>
+int DBIndex<IdT, T>::emplace(const IdT& id, Args&&... args) {
+
+	rows_.emplace_back(std::forward<Args>(args)...);
+	ids_.push_back(id);
+	return IN_OK;
+}
+
+template<typename IdT, typename T>
+int DBIndex<IdT, T>::absorb(DBIndex& other) {
+
+	rows_.insert(rows_.end(), std::make_move_iterator(other.rows_.begin()),
+				 std::make_move_iterator(other.rows_.end()));
+	ids_.insert(ids_.end(), other.ids_.begin(), other.ids_.end());
+	strings_.absorb(other.strings_);
+
+	std::vector<T>().swap(other.rows_);
+	std::vector<IdT>().swap(other.ids_);
+	return IN_OK;
+}
+
+template<typename IdT, typename T>
+template<typename Less>
+int DBIndex<IdT, T>::build(Less less) {
+
+	IdT maxId = 0;
+	for (const auto& id : ids_)
+		maxId = std::max(maxId, id);
+
+	// count the rows of every key and turn the counts into offsets
+	offsets_.assign(rows_.empty() ? 1 : maxId + 2, 0);
+	for (const auto& id : ids_)
+		++offsets_[id + 1];
+	for (size_t i = 1; i < offsets_.size(); ++i)
+		offsets_[i] += offsets_[i - 1];
+
+	// slot of every row within its key (stable)
+	std::vector<IdT> slot(rows_.size());
+	std::vector<IdT> next(offsets_.begin(), offsets_.end() - 1);
+	for (size_t i = 0; i < ids_.size(); ++i)
+		slot[i] = next[ids_[i]]++;
+	std::vector<IdT>().swap(ids_);
+
+	// move the rows into their slots in place, one cycle at a time
+	for (size_t i = 0; i < slot.size(); ++i) {
+		while (slot[i] != i) {
+			IdT j = slot[i];
+			std::swap(rows_[i], rows_[j]);
+			std::swap(slot[i], slot[j]);
+		}
+	}
+
+	// order the rows within every key
+	for (size_t i = 0; i + 1 < offsets_.size(); ++i)
+		if (offsets_[i + 1] - offsets_[i] > 1)
+			std::stable_sort(rows_.begin() + offsets_[i],
+							 rows_.begin() + offsets_[i + 1], less);
+
+	return IN_OK;
+}
+
+template<typename IdT, typename T>
+typename DBIndex<IdT, T>::Range DBIndex<IdT, T>::get(const IdT& id) {
+
+	if ( static_cast<typename std::vector<IdT>::size_type>(id) + 1
+			>= offsets_.size() )
+		return Range(end(), end());
+
+	return Range(rows_.data() + offsets_[id], rows_.data() + offsets_[id + 1]);
+}
+
+template<typename IdT, typename T>
+size_t DBIndex<IdT, T>::size() const {
+	return rows_.size();
+}
+
+template<typename IdT, typename T>
+typename DBIndex<IdT, T>::iterator DBIndex<IdT, T>::begin() {
+	return rows_.data();
+}
+
+template<typename IdT, typename T>
+typename DBIndex<IdT, T>::const_iterator DBIndex<IdT, T>::begin() const {
+	return rows_.data();
+}
+
+template<typename IdT, typename T>
+typename DBIndex<IdT, T>::iterator DBIndex<IdT, T>::end() {
+	return rows_.data() + rows_.size();
+}
+
+template<typename IdT, typename T>
+typename DBIndex<IdT, T>::const_iterator DBIndex<IdT, T>::end() const {
+	return rows_.data() + rows_.size();
+}
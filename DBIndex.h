@@ -0,0 +1,71 @@
+/*
+ * DBIndex.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef DBINDEX_H_
+#define DBINDEX_H_
+
+#include <vector>
+#include "StringArena.h"
+
+/******************************************************************************
+ * DBIndex
+ *
+ * Compressed sparse row index for 1:n tables with a dense integer foreign
+ * key (e.g. the accesses of an instruction). Rows are appended in any
+ * order while loading; build() then groups them by key in one counting
+ * pass, orders every group, and records one offset per key. Afterwards
+ * all rows of a key form one contiguous slice.
+ *****************************************************************************/
+template<typename IdT, typename T>
+class DBIndex
+{
+public:
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	class Range {
+	public:
+		Range(iterator first, iterator last) : first_(first), last_(last) {}
+		iterator begin() const { return first_; }
+		iterator end() const { return last_; }
+		bool empty() const { return first_ == last_; }
+		size_t size() const { return last_ - first_; }
+	private:
+		iterator first_, last_;
+	};
+
+	DBIndex();
+	~DBIndex();
+
+	int fill(const IdT& id, const T& entry);
+	template<typename... Args> int emplace(const IdT& id, Args&&... args);
+	int absorb(DBIndex& other);	// append the rows of other, before build()
+	template<typename Less> int build(Less less);
+
+	Range get(const IdT& id);
+	size_t size() const;
+
+	iterator		begin();
+	const_iterator	begin() const;
+	iterator		end();
+	const_iterator	end() const;
+
+	StringArena& strings() { return strings_; }
+
+private:
+	std::vector<T> rows_;
+	std::vector<IdT> ids_;			// key of every row until build()
+	std::vector<IdT> offsets_;		// first row of every key, plus end
+	StringArena strings_;
+
+	// prevent generated functions
+	DBIndex(const DBIndex&);
+	DBIndex& operator=(const DBIndex&);
+};
+
+#include "DBIndex-inl.h"
+
+#endif /* DBINDEX_H_ */
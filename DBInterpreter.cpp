@@ -10,6 +10,13 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <sys/stat.h>
 #include <boost/log/core.hpp>
 #include <boost/log/trivial.hpp>
 #include "Event.h"
@@ -20,14 +27,78 @@
 #include "LockMgr.h"
 #include "ThreadMgr.h"
 #include "DBTable.h"
+#include "TraceCache.h"
+#include "ShardReader.h"
+#include "ExternalSort.h"
+#include "RunReport.h"
+
+// Text of a column, or an empty string for NULL. The view is only valid
+// until the statement is stepped again.
+static inline const char* columnText(sqlite3_stmt *stmt, int col) {
+	const unsigned char *text = sqlite3_column_text(stmt, col);
+	return text != nullptr ? (const char*)text : "";
+}
+
+template<typename Row>
+static inline const char* columnText(const Row& row, int col) {
+	const unsigned char *text = row.getText(col);
+	return text != nullptr ? (const char*)text : "";
+}
+
+// Bytes of the values of a row as stored, without converting any column.
+static unsigned long rowBytes(sqlite3_stmt *stmt) {
+
+	unsigned long bytes = 0;
+	for (int col = sqlite3_column_count(stmt) - 1; col >= 0; --col) {
+		switch (sqlite3_column_type(stmt, col)) {
+		case SQLITE_INTEGER:
+		case SQLITE_FLOAT:
+			bytes += 8;
+			break;
+		case SQLITE_TEXT:
+		case SQLITE_BLOB:
+			bytes += sqlite3_column_bytes(stmt, col);
+			break;
+		}
+	}
+	return bytes;
+}
+
+// Memory a loaded table keeps for its rows and their text.
+template<typename TableT>
+static size_t footprint(TableT& table) {
+	return table.size() * sizeof(*table.begin()) + table.strings().bytes();
+}
+
+// Row of the stream query a statement is positioned on.
+class StmtRow {
+public:
+	explicit StmtRow(sqlite3_stmt *stmt) : stmt_(stmt) {}
+
+	bool isNull(int col) const {
+		return sqlite3_column_type(stmt_, col) == SQLITE_NULL;
+	}
+	sqlite3_int64 getInt(int col) const { return sqlite3_column_int64(stmt_, col); }
+	const unsigned char* getText(int col) const {
+		return sqlite3_column_text(stmt_, col);
+	}
+
+private:
+	sqlite3_stmt *stmt_;
+};
 
 DBInterpreter::DBInterpreter(const char* DBPath,
 							 const char* logFile,
 							 EventService *service,
 							 LockMgr *lockMgr,
-							 ThreadMgr *threadMgr) 
-	: Interpreter(lockMgr, threadMgr, logFile), _dbPath(DBPath), _logFile(logFile),
-	  _eventService(service) { }
+							 ThreadMgr *threadMgr,
+							 Mode mode)
+	: Interpreter(lockMgr, threadMgr, logFile), _dbPath(DBPath),
+	  _disjointShards(false), _logFile(logFile), _cacheFile(nullptr), _mode(mode), _readProfile(ReadProfile::forSize(0)),
+	  _autoProfile(true), _tailProfile(TailProfile::defaults()),
+	  _spillBudget(1024 * 1024 * 1024), _spillDirectory("/tmp"), _events(ALL),
+	  _needFiles(false), _scope(), _eventService(service), _loadedRows(0),
+	  _loadedBytes(0) { }
 
 DBInterpreter::~DBInterpreter(){ }
 
@@ -35,22 +106,6 @@ EventService* DBInterpreter::getEventService() {
 	return _eventService;
 }
 
-Instruction::type DBInterpreter::transformInstrType(const instruction_t &ins) {
-
-	if (strcmp( ins.instruction_type, "CALL") == 0)
-		return Instruction::CALL;
-	else if (strcmp( ins.instruction_type, "ACCESS" ) == 0)
-		return Instruction::MEMACCESS;
-	else if (strcmp( ins.instruction_type, "CSENTER" ) == 0)
-		return Instruction::ACQUIRE;
-	else if (strcmp( ins.instruction_type, "CSLEAVE" ) == 0)
-		return Instruction::RELEASE;
-	else if (strcmp( ins.instruction_type, "THRCREATE" ) == 0)
-		return Instruction::FORK;
-
-	return Instruction::OTHER;
-}
-
 int DBInterpreter::loadDB(const char* path, sqlite3 **db) {
 
 	if (sqlite3_open_v2(path, db,
@@ -59,10 +114,47 @@ int DBInterpreter::loadDB(const char* path, sqlite3 **db) {
 								 << sqlite3_errmsg(*db);
 		sqlite3_close(*db);
 		return IN_ABORT;
-	} else {
-		BOOST_LOG_TRIVIAL(trace) << "successfully opened " << path;
-		return IN_OK;
 	}
+
+	std::ostringstream pragmas;
+	pragmas << "PRAGMA mmap_size = " << _readProfile.mmapSize << ";"
+			<< "PRAGMA cache_size = " << _readProfile.cacheSize << ";"
+			<< "PRAGMA temp_store = " << _readProfile.tempStore << ";"
+			<< "PRAGMA query_only = " << (_readProfile.queryOnly ? 1 : 0) << ";";
+	if (sqlite3_exec(*db, pragmas.str().c_str(), NULL, NULL, NULL) != SQLITE_OK)
+		BOOST_LOG_TRIVIAL(warning) << "Can't apply read profile to " << path
+								   << " - error: " << sqlite3_errmsg(*db);
+
+	BOOST_LOG_TRIVIAL(trace) << "successfully opened " << path;
+	return IN_OK;
+}
+
+DBInterpreter::ReadProfile DBInterpreter::ReadProfile::forSize(sqlite3_int64 dbSize) {
+
+	static const sqlite3_int64 MiB = 1024 * 1024;
+
+	ReadProfile profile;
+	profile.mmapSize = dbSize;	// SQLite clamps this to SQLITE_MAX_MMAP_SIZE
+	profile.cacheSize = dbSize < 256 * MiB ? -16 * 1024 : -64 * 1024;
+	profile.tempStore = dbSize < 1024 * MiB ? 2 : 1;	// large sorts spill to disk
+	profile.queryOnly = true;
+	return profile;
+}
+
+DBInterpreter::TailProfile DBInterpreter::TailProfile::defaults() {
+
+	TailProfile profile;
+	profile.batchSize = 10000;
+	profile.pollInterval = 200;
+	profile.idleTimeout = 60000;
+	profile.endMarker = "TRACE_END";
+	return profile;
+}
+
+void DBInterpreter::setReadProfile(const ReadProfile& profile) {
+
+	_readProfile = profile;
+	_autoProfile = false;
 }
 
 int DBInterpreter::closeDB(sqlite3 **db) {
@@ -76,37 +168,748 @@ int DBInterpreter::closeDB(sqlite3 **db) {
 
 int DBInterpreter::process() {
 
-	sqlite3 *db;
+	// only a LOAD of a single database keeps every table to write a cache of
+	const char *cacheFile = _cacheFile;
+	if (cacheFile != nullptr && (_mode != LOAD || !_shards.empty())) {
+		BOOST_LOG_TRIVIAL(warning) << "No trace cache is written in this mode,"
+								   << " only in LOAD mode of a single database";
+		cacheFile = nullptr;
+	}
 
-	// open the database
-	if ( loadDB(_dbPath, &db) != IN_OK ) {
+	// a trace cache must hold every table and row, whatever is subscribed now
+	_events = cacheFile != nullptr ? ALL : _eventService->subscribedEvents();
+	_needFiles = _eventService->filtersFiles();
+	if (cacheFile == nullptr)
+		_eventService->getCommonFilter(&_pushdown);
+
+	// the database as it is before the load, recorded in the cache
+	TraceCache::Source source;
+	if (cacheFile != nullptr && TraceCache::identify(_dbPath, &source) != IN_OK)
+		cacheFile = nullptr;
+
+	if (_autoProfile) {
+		struct stat info;
+		sqlite3_int64 dbSize = stat(_dbPath, &info) == 0 ? info.st_size : 0;
+		_readProfile = ReadProfile::forSize(dbSize);
+		BOOST_LOG_TRIVIAL(trace) << "Read profile for " << dbSize << " bytes:"
+								 << " mmap_size " << _readProfile.mmapSize
+								 << ", cache_size " << _readProfile.cacheSize
+								 << ", temp_store " << _readProfile.tempStore;
+	}
+
+	// continue after the last checkpointed instruction
+	if (restoreCheckpoint() != IN_OK)
 		return IN_ABORT;
+
+	// interpret the rows of all shards while they are read
+	RunReport::Mark start = RunReport::now();
+	if (!_shards.empty()) {
+		int rc = processMerge();
+		if (report_ != nullptr)
+			report_->phase("interpret", start, instructionsDone());
+		return rc;
+	}
+
+	// interpret the rows while they are read, without filling any table
+	if (_mode == STREAM || _mode == TAIL) {
+		sqlite3 *db;
+
+		// open the database
+		if ( loadDB(_dbPath, &db) != IN_OK ) {
+			return IN_ABORT;
+		}
+
+		int rc = _mode == TAIL ? processTail(&db) : processStream(&db);
+		closeDB(&db);
+		if (report_ != nullptr)
+			report_->phase("interpret", start, instructionsDone());
+		return rc;
 	}
 
 	// fill the internal maps with database entries
-	int rc = fillStructures(&db);
+	int rc = fillStructures();
 	if ( rc != IN_OK) {
 		BOOST_LOG_TRIVIAL(error) << "Can't fill internal structures."
 								 << " Error code: " << rc;
 		return IN_ABORT;
 	}
+	if (report_ != nullptr)
+		report_->phase("load", start, _loadedRows, _loadedBytes);
+
+	// resolve string keys to ids
+	start = RunReport::now();
+	linkStructures();
+	if (report_ != nullptr)
+		report_->phase("link", start, instructionT_.size());
+
+	start = RunReport::now();
+	if (cacheFile != nullptr) {
+		writeCache(cacheFile, source);
+		if (report_ != nullptr)
+			report_->phase("cache", start, instructionT_.size());
+	}
+
+	// resolve ids to shadow entities
+	start = RunReport::now();
+	linkShadows();
+	if (report_ != nullptr)
+		report_->phase("shadows", start, referenceT_.size());
+
+	start = RunReport::now();
+	if (_mode == EXTERNAL) {
+		rc = processExternal();
+		if (report_ != nullptr)
+			report_->phase("interpret", start, instructionsDone());
+		return rc;
+	}
 
 	// process database entries
-	for (auto instruction : instructionT_)
+	for (const auto& instruction : instructionT_) {
+		if (isResumed(instruction.first))
+			continue;
 		processInstruction(instruction.second);
+		instructionDone(instruction.first);
+	}
+	if (report_ != nullptr)
+		report_->phase("interpret", start, instructionsDone());
 
-	closeDB(&db);
 	return 0;
 }
 
+// One row per (instruction, access) pair in instruction order. Instructions
+// without accesses yield a single row whose access columns are NULL. The
+// function and file columns are only joined if they are needed.
+static const char *kStreamColumns =
+	"SELECT i.id, i.segment_id, i.instruction_type, i.line_number,"		//  0- 3
+	" s.call_id, s.segment_no, s.segment_type, s.loop_pointer,"			//  4- 7
+	" c.process_id, c.thread_id, c.function_id, c.instruction_id,"		//  8-11
+	" c.start_time, c.end_time,"										// 12-13
+	" a.id, a.position, a.reference_id, a.access_type, a.memory_state,"	// 14-18
+	" r.id, r.size, r.memory_type, r.name, r.allocinstr,"				// 19-23
+	" t.id, t.parent_thread_id, t.child_thread_id,";					// 24-26
+static const char *kStreamFunctionColumns =
+	" f.signature, f.type, f.file_id, fi.file_name, fi.file_path";		// 27-31
+static const char *kStreamNoFunctionColumns =
+	" NULL, NULL, NULL, NULL, NULL";									// 27-31
+static const char *kStreamJoins =
+	" FROM INSTRUCTION_TABLE i"
+	" LEFT JOIN SEGMENT_TABLE s ON s.id = i.segment_id"
+	" LEFT JOIN CALL_TABLE c ON c.id = s.call_id"
+	" LEFT JOIN ACCESS_TABLE a ON a.instruction_id = i.id"
+	" LEFT JOIN REFERENCE_TABLE r ON r.reference_id = a.reference_id"
+	" LEFT JOIN THREAD_TABLE t ON t.instruction_id = i.id";
+static const char *kStreamFunctionJoins =
+	" LEFT JOIN FUNCTION_TABLE f ON f.id = c.function_id"
+	" LEFT JOIN FILE_TABLE fi ON fi.id = f.file_id";
+static const char *kStreamOrder =
+	" ORDER BY i.id, a.position, a.id;";
+
+std::string DBInterpreter::streamQuery(bool bounded) const {
+
+	bool functions = (_events & CALL) || _needFiles;
+	std::string query = kStreamColumns;
+	query += functions ? kStreamFunctionColumns : kStreamNoFunctionColumns;
+	query += kStreamJoins;
+	if (functions)
+		query += kStreamFunctionJoins;
+
+	std::string where;
+	if (isResuming() && _shards.empty())
+		where += " AND i.id > " + std::to_string(getResumePoint());
+	if (bounded)	// instruction ids (?1, ?2]
+		where += " AND i.id > ?1 AND i.id <= ?2";
+	if ((_events & CALL) == 0)
+		where += " AND i.instruction_type <> 'CALL'";
+	std::string calls = callPredicate("c.");
+	if (!calls.empty())
+		where += " AND " + calls;
+	std::string memory = memoryPredicate("r.");
+	if (!memory.empty())
+		where += " AND (i.instruction_type <> 'ACCESS' OR " + memory + ")";
+	if (!where.empty())
+		query += " WHERE" + where.substr(4);
+
+	return query + kStreamOrder;
+}
+
+int DBInterpreter::processStream(sqlite3 **db) {
+
+	sqlite3_stmt *sqlstmt = 0;
+
+	std::string query = streamQuery(false);
+	if (sqlite3_prepare_v2(*db, query.c_str(), -1, &sqlstmt, NULL) != SQLITE_OK) {
+		BOOST_LOG_TRIVIAL(error) << "Error preparing db: " << sqlite3_errmsg(*db);
+		return IN_ABORT;
+	}
+
+	int rc = stepStream(db, sqlstmt);
+	sqlite3_finalize(sqlstmt);
+	return rc;
+}
+
+int DBInterpreter::stepStream(sqlite3 **db, sqlite3_stmt *sqlstmt) {
+
+	// an instruction is done once the rows of the next one start
+	int rc = IN_OK;
+	bool reading = true, started = false;
+	INS_ID current = 0;
+	while (reading) {
+		switch(sqlite3_step(sqlstmt)) {
+		case SQLITE_ROW:
+		{
+			INS_ID id = sqlite3_column_int64(sqlstmt, 0);
+			if (started && id != current)
+				instructionDone(current);
+			started = true;
+			current = id;
+			processStreamRow(StmtRow(sqlstmt));
+			break;
+		}
+		case SQLITE_DONE:
+			if (started)
+				instructionDone(current);
+			reading = false;
+			break;
+		default:
+			BOOST_LOG_TRIVIAL(error) << "Iterating db failed: "
+									 << sqlite3_errmsg(*db);
+			rc = IN_ABORT;
+			reading = false;
+			break;
+		}
+	}
+
+	sqlite3_reset(sqlstmt);
+	return rc;
+}
+
+// Single integer result of a query; IN_NO_ENTRY for no row or NULL.
+static int queryInt(sqlite3 *db, sqlite3_stmt *stmt, sqlite3_int64 *value) {
+
+	int rc;
+	switch (sqlite3_step(stmt)) {
+	case SQLITE_ROW:
+		rc = IN_NO_ENTRY;
+		if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+			*value = sqlite3_column_int64(stmt, 0);
+			rc = IN_OK;
+		}
+		break;
+	case SQLITE_DONE:
+		rc = IN_NO_ENTRY;
+		break;
+	default:
+		BOOST_LOG_TRIVIAL(error) << "Polling db failed: " << sqlite3_errmsg(db);
+		rc = IN_ABORT;
+		break;
+	}
+
+	sqlite3_reset(stmt);
+	return rc;
+}
+
+// Last instruction id of the next batch past ?1, at most ?2 instructions.
+static const char *kTailBatchEnd =
+	"SELECT MAX(id) FROM"
+	" (SELECT id FROM INSTRUCTION_TABLE WHERE id > ?1 ORDER BY id LIMIT ?2);";
+// First instruction in (?1, ?2] that lacks rows it is interpreted with: its
+// call, an access (of accesses and lock operations), the reference of an
+// access, or the thread row of a fork.
+static const char *kTailIncomplete =
+	"SELECT MIN(i.id) FROM INSTRUCTION_TABLE i"
+	" LEFT JOIN SEGMENT_TABLE s ON s.id = i.segment_id"
+	" LEFT JOIN CALL_TABLE c ON c.id = s.call_id"
+	" LEFT JOIN ACCESS_TABLE a ON a.instruction_id = i.id"
+	" LEFT JOIN REFERENCE_TABLE r ON r.reference_id = a.reference_id"
+	" LEFT JOIN THREAD_TABLE t ON t.instruction_id = i.id"
+	" WHERE i.id > ?1 AND i.id <= ?2 AND (c.id IS NULL"
+	"  OR (i.instruction_type IN ('ACCESS', 'CSENTER', 'CSLEAVE')"
+	"      AND (a.id IS NULL OR r.id IS NULL))"
+	"  OR (i.instruction_type = 'THRCREATE' AND t.id IS NULL));";
+static const char *kTailEndMarker =
+	"SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?1;";
+
+// Interprets the instructions past a high-water mark in batches, each read
+// within one transaction so that a batch and the end marker are taken from
+// the same snapshot (a WAL writer may commit meanwhile). A batch ends before
+// the first instruction whose dependent rows are missing (see
+// kTailIncomplete), as the writer may still be adding them; it is held back
+// until they arrive, the end marker shows up or no rows arrived for the idle
+// timeout.
+int DBInterpreter::processTail(sqlite3 **db) {
+
+	if (_tailProfile.batchSize == 0) {
+		BOOST_LOG_TRIVIAL(error) << "Tailing needs a positive batch size";
+		return IN_ABORT;
+	}
+
+	sqlite3_busy_timeout(*db, _tailProfile.pollInterval);
+
+	sqlite3_stmt *rows = 0, *batchEnd = 0, *incomplete = 0, *endMarker = 0;
+	std::string query = streamQuery(true);
+	if (sqlite3_prepare_v2(*db, query.c_str(), -1, &rows, NULL) != SQLITE_OK ||
+		sqlite3_prepare_v2(*db, kTailBatchEnd, -1, &batchEnd, NULL) != SQLITE_OK ||
+		sqlite3_prepare_v2(*db, kTailIncomplete, -1, &incomplete, NULL) != SQLITE_OK ||
+		sqlite3_prepare_v2(*db, kTailEndMarker, -1, &endMarker, NULL) != SQLITE_OK) {
+		BOOST_LOG_TRIVIAL(error) << "Error preparing db: " << sqlite3_errmsg(*db);
+		sqlite3_finalize(rows);
+		sqlite3_finalize(batchEnd);
+		sqlite3_finalize(incomplete);
+		sqlite3_finalize(endMarker);
+		return IN_ABORT;
+	}
+	sqlite3_bind_int(batchEnd, 2, _tailProfile.batchSize);
+	sqlite3_bind_text(endMarker, 1, _tailProfile.endMarker, -1, SQLITE_STATIC);
+
+	typedef std::chrono::steady_clock clock;
+	clock::time_point lastRows = clock::now();
+	sqlite3_int64 highWater = -1;
+	if (isResuming())
+		highWater = getResumePoint();
+	bool finishing = false;
+	int rc = IN_OK;
+	while (rc == IN_OK) {
+		sqlite3_int64 upper = highWater, held, marker;
+
+		sqlite3_exec(*db, "BEGIN;", NULL, NULL, NULL);
+		rc = queryInt(*db, endMarker, &marker);
+		bool ended = finishing || rc == IN_OK;
+		if (rc != IN_ABORT) {
+			sqlite3_bind_int64(batchEnd, 1, highWater);
+			rc = queryInt(*db, batchEnd, &upper);
+		}
+		if (rc == IN_OK && !ended) {
+			sqlite3_bind_int64(incomplete, 1, highWater);
+			sqlite3_bind_int64(incomplete, 2, upper);
+			rc = queryInt(*db, incomplete, &held);
+			if (rc == IN_OK)
+				upper = held - 1;
+		}
+		if (rc != IN_ABORT && upper > highWater) {
+			sqlite3_bind_int64(rows, 1, highWater);
+			sqlite3_bind_int64(rows, 2, upper);
+			rc = stepStream(db, rows);
+			BOOST_LOG_TRIVIAL(trace) << "Tailed instructions " << highWater + 1
+									 << " to " << upper;
+		}
+		sqlite3_exec(*db, "COMMIT;", NULL, NULL, NULL);
+
+		if (rc == IN_ABORT)
+			break;
+		rc = IN_OK;
+
+		if (upper > highWater) {
+			highWater = upper;
+			lastRows = clock::now();
+		} else if (ended) {
+			break;
+		} else if (clock::now() - lastRows >=
+				   std::chrono::milliseconds(_tailProfile.idleTimeout)) {
+			BOOST_LOG_TRIVIAL(warning) << "No new rows for "
+									   << _tailProfile.idleTimeout
+									   << " ms, finishing the trace";
+			finishing = true;
+		} else {
+			std::this_thread::sleep_for(
+					std::chrono::milliseconds(_tailProfile.pollInterval));
+		}
+	}
+
+	sqlite3_finalize(rows);
+	sqlite3_finalize(batchEnd);
+	sqlite3_finalize(incomplete);
+	sqlite3_finalize(endMarker);
+	return rc;
+}
+
+// Largest ids of a shard, the ones of the next shard follow them.
+static const char *kShardExtent =
+	"SELECT (SELECT IFNULL(MAX(id), 0) FROM INSTRUCTION_TABLE),"
+	" (SELECT IFNULL(MAX(thread_id), 0) FROM CALL_TABLE),"
+	" (SELECT IFNULL(MAX(MAX(parent_thread_id), MAX(child_thread_id)), 0)"
+	"  FROM THREAD_TABLE),"
+	" (SELECT IFNULL(MAX(id), 0) FROM REFERENCE_TABLE),"
+	" (SELECT IFNULL(MAX(id), 0) FROM SEGMENT_TABLE),"
+	" (SELECT IFNULL(MAX(id), 0) FROM ACCESS_TABLE);";
+static const char *kShardReferences =
+	"SELECT id, reference_id FROM REFERENCE_TABLE ORDER BY id;";
+
+// Maps the reference ids of a shard to the ids of the merged trace by
+// REF_NO: the first shard keeps its ids, a REF_NO first seen in a later
+// shard gets the next id past all ids given so far.
+static int mapReferences(sqlite3 *db,
+						 std::unordered_map<std::string, REF_ID> *merged,
+						 REF_ID *next, ShardReader::References *references) {
+
+	sqlite3_stmt *stmt = 0;
+	if (sqlite3_prepare_v2(db, kShardReferences, -1, &stmt, NULL) != SQLITE_OK)
+		return IN_ABORT;
+
+	bool first = merged->empty();
+	int rc;
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		REF_ID id = sqlite3_column_int64(stmt, 0);
+		const unsigned char *refNo = sqlite3_column_text(stmt, 1);
+		if (refNo == nullptr)
+			continue;
+		auto entry = merged->emplace((const char*)refNo, first ? id : *next);
+		if (entry.second)
+			*next = std::max(*next, entry.first->second + 1);
+		(*references)[id] = entry.first->second;
+	}
+
+	sqlite3_finalize(stmt);
+	return rc == SQLITE_DONE ? IN_OK : IN_ABORT;
+}
+
+// Merges the stream queries of all shards by instruction id; equal ids are
+// taken in shard order. Segment and access ids of each shard are shifted
+// past the ones of the shards before it. Instruction and thread ids are
+// kept and reference ids mapped by REF_NO, unless the shards are disjoint
+// (see setDisjointShards) and these are shifted as well. The shards are
+// decoded on their own threads (see ShardReader). Checkpoints count
+// instructions in merge order.
+int DBInterpreter::processMerge() {
+
+	std::vector<const char*> paths(1, _dbPath);
+	paths.insert(paths.end(), _shards.begin(), _shards.end());
+
+	std::string query = streamQuery(false);
+	std::vector<std::unique_ptr<ShardReader>> readers;
+	ShardReader::Offsets offsets = { 0, 0, 0, 0, 0 };
+	std::unordered_map<std::string, REF_ID> mergedReferences;
+	REF_ID nextReference = 0;
+	for (auto path : paths) {
+		sqlite3 *db;
+		if (loadDB(path, &db) != IN_OK)
+			return IN_ABORT;
+
+		sqlite3_stmt *extent = 0, *rows = 0;
+		if (sqlite3_prepare_v2(db, kShardExtent, -1, &extent, NULL) != SQLITE_OK ||
+			sqlite3_step(extent) != SQLITE_ROW ||
+			sqlite3_prepare_v2(db, query.c_str(), -1, &rows, NULL) != SQLITE_OK) {
+			BOOST_LOG_TRIVIAL(error) << "Error preparing shard " << path << ": "
+									 << sqlite3_errmsg(db);
+			sqlite3_finalize(extent);
+			closeDB(&db);
+			return IN_ABORT;
+		}
+
+		ShardReader::References references;
+		if (!_disjointShards &&
+			mapReferences(db, &mergedReferences, &nextReference,
+						  &references) != IN_OK) {
+			BOOST_LOG_TRIVIAL(error) << "Error reading the references of shard "
+									 << path << ": " << sqlite3_errmsg(db);
+			sqlite3_finalize(extent);
+			sqlite3_finalize(rows);
+			closeDB(&db);
+			return IN_ABORT;
+		}
+
+		readers.emplace_back(new ShardReader(db, rows, offsets,
+											 std::move(references)));
+		if (_disjointShards) {
+			offsets.instruction += sqlite3_column_int64(extent, 0) + 1;
+			offsets.thread += std::max(sqlite3_column_int(extent, 1),
+									   sqlite3_column_int(extent, 2)) + 1;
+			offsets.reference += sqlite3_column_int64(extent, 3) + 1;
+		}
+		offsets.segment += sqlite3_column_int64(extent, 4) + 1;
+		offsets.access += sqlite3_column_int64(extent, 5) + 1;
+		sqlite3_finalize(extent);
+	}
+
+	for (auto& reader : readers)
+		reader->start();
+
+	typedef std::pair<INS_ID, size_t> head_t;	// instruction id, shard
+	std::priority_queue<head_t, std::vector<head_t>,
+						std::greater<head_t>> heads;
+	for (size_t shard = 0; shard < readers.size(); ++shard)
+		if (readers[shard]->next())
+			heads.push(head_t(readers[shard]->key(), shard));
+
+	INS_ID position = 0;	// of the current instruction in merge order
+	head_t current(0, readers.size());
+	while (!heads.empty()) {
+		head_t head = heads.top();
+		heads.pop();
+
+		if (head != current) {
+			if (current.second < readers.size() && !isResumed(position))
+				instructionDone(position);
+			++position;
+			current = head;
+		}
+
+		ShardReader *reader = readers[head.second].get();
+		if (!isResumed(position))
+			processStreamRow(reader->row());
+		if (reader->next())
+			heads.push(head_t(reader->key(), head.second));
+	}
+	if (current.second < readers.size() && !isResumed(position))
+		instructionDone(position);
+
+	for (auto& reader : readers)
+		if (reader->status() != IN_OK)
+			return IN_ABORT;
+	return IN_OK;
+}
+
+// Access row as sorted by processExternal; the reference is resolved.
+typedef struct spillAccess_t {
+	INS_ID instruction_id;
+	int position;
+	ACC_ID id;
+	REF_ID reference_id;
+	Access::type access_type;
+
+	// the order of the accesses in the access index
+	bool operator<(const spillAccess_t& other) const {
+		if (instruction_id != other.instruction_id)
+			return instruction_id < other.instruction_id;
+		if (position != other.position)
+			return position < other.position;
+		return id < other.id;
+	}
+} spillAccess_t;
+
+// Interprets the trace with all tables but ACCESS_TABLE and
+// INSTRUCTION_TABLE loaded. The accesses are sorted by instruction within
+// the spill budget (see ExternalSort) and merge joined with the
+// instructions, which SQLite returns in id order.
+int DBInterpreter::processExternal() {
+
+	static const int ACCESSES = ACCESS | ACQUIRE | RELEASE;
+
+	sqlite3 *db;
+	if ( loadDB(_dbPath, &db) != IN_OK )
+		return IN_ABORT;
+
+	ExternalSort<spillAccess_t, std::less<spillAccess_t>> sorted(_spillBudget,
+																_spillDirectory);
+	int rc = IN_OK;
+	sqlite3_stmt *sqlstmt = 0;
+	std::string sql = "SELECT id, instruction_id, position, reference_id, access_type"
+					  " FROM ACCESS_TABLE";
+	std::string where = accessWhere();
+	if (!where.empty())
+		sql += " WHERE " + where;
+	if ((_events & ACCESSES) != 0) {
+		if (sqlite3_prepare_v2(db, sql.c_str(), -1, &sqlstmt, NULL) != SQLITE_OK) {
+			BOOST_LOG_TRIVIAL(error) << "Error preparing db: " << sqlite3_errmsg(db);
+			closeDB(&db);
+			return IN_ABORT;
+		}
+		rc = stepRows("ACCESS_TABLE", sql.c_str(), db, sqlstmt,
+					  [this, &sorted](sqlite3_stmt *stmt) {
+			spillAccess_t access;
+			access.id = sqlite3_column_int64(stmt, 0);
+			access.instruction_id = sqlite3_column_int64(stmt, 1);
+			access.position = sqlite3_column_int(stmt, 2);
+			auto search = _refNoIdMap.find(columnText(stmt, 3));
+			access.reference_id = search != _refNoIdMap.end() ? search->second : NO_ID;
+			access.access_type = access_t::getAccessType(*columnText(stmt, 4));
+			return sorted.add(access);
+		});
+		sqlite3_finalize(sqlstmt);
+	}
+	if (rc == IN_OK)
+		rc = sorted.finish();
+	BOOST_LOG_TRIVIAL(trace) << "Sorted accesses in " << sorted.runs() << " runs";
+
+	sql = "SELECT * FROM INSTRUCTION_TABLE";
+	where = instructionWhere();
+	if (!where.empty())
+		sql += " WHERE " + where;
+	sql += " ORDER BY id;";
+	if (rc != IN_OK ||
+		sqlite3_prepare_v2(db, sql.c_str(), -1, &sqlstmt, NULL) != SQLITE_OK) {
+		BOOST_LOG_TRIVIAL(error) << "Error preparing db: " << sqlite3_errmsg(db);
+		closeDB(&db);
+		return IN_ABORT;
+	}
+
+	std::vector<access_t> accesses;
+	spillAccess_t next;
+	bool more = sorted.next(&next);
+	rc = stepRows("INSTRUCTION_TABLE", sql.c_str(), db, sqlstmt,
+				  [&](sqlite3_stmt *stmt) -> int {
+		instruction_t ins(sqlite3_column_int64(stmt, 0),
+						  sqlite3_column_int64(stmt, 1),
+						  columnText(stmt, 2),
+						  sqlite3_column_int(stmt, 3));
+
+		accesses.clear();
+		while (more && next.instruction_id < ins.instruction_id)
+			more = sorted.next(&next);
+		for (; more && next.instruction_id == ins.instruction_id;
+			 more = sorted.next(&next)) {
+			accesses.emplace_back(next.id, next.instruction_id, next.position,
+								  "", "", "");
+			accesses.back().reference_id = next.reference_id;
+			accesses.back().access_type = next.access_type;
+		}
+		if (sorted.status() != IN_OK)
+			return IN_ABORT;	// the accesses of the run are incomplete
+
+		if (isResumed(ins.instruction_id))
+			return IN_OK;
+		int result = processInstruction(ins, DBIndex<INS_ID, access_t>::Range(
+				accesses.data(), accesses.data() + accesses.size()));
+		instructionDone(ins.instruction_id);
+		return result;
+	});
+
+	sqlite3_finalize(sqlstmt);
+	closeDB(&db);
+	return sorted.status() != IN_OK ? IN_ABORT : rc;
+}
+
+template<typename Row>
+int DBInterpreter::processStreamRow(const Row& row) {
+
+	instruction_t ins(row.getInt(0),
+					  row.getInt(1),
+					  columnText(row, 2),
+					  row.getInt(3));
+
+	if ((instructionEvents(ins.instruction_type) & _events) == 0)
+		return IN_OK;
+
+	if (row.isNull(4)) {
+		BOOST_LOG_TRIVIAL(error) << "Segment not found: " << ins.segment_id;
+		return IN_NO_ENTRY;
+	}
+	segment_t segment(columnText(row, 4),
+					  row.getInt(5),
+					  row.getText(6),
+					  row.getInt(7));
+
+	if (row.isNull(8)) {
+		BOOST_LOG_TRIVIAL(error) << "Call not found: " << segment.call_no;
+		return IN_NO_ENTRY;
+	}
+	call_t call(row.getInt(8),
+				row.getInt(9),
+				row.getInt(10),
+				row.getInt(11),
+				row.getText(12),
+				row.getText(13));
+	setScope(call, !row.isNull(29) ?
+				   row.getInt(29) : NO_ID32);
+
+	processAccess_t accessFunc = nullptr;
+
+	switch( ins.instruction_type ) {
+	case Instruction::CALL:
+		{
+			if (row.isNull(27)) {
+				BOOST_LOG_TRIVIAL(error) << "Function not found: " << call.function_id;
+				return IN_NO_ENTRY;
+			}
+			function_t function(columnText(row, 27),
+								columnText(row, 28),
+								row.getInt(29));
+
+			switch(function.type) {
+			case Function::FUNCTION:
+			case Function::METHOD:
+				if (row.isNull(30)) {
+					BOOST_LOG_TRIVIAL(error) << "File not found: " << function.file_id;
+					return IN_NO_ENTRY;
+				} else {
+					file_t file(columnText(row, 30),
+								columnText(row, 31));
+					return processCall(call, function, file);
+				}
+			default:
+				return IN_OK;
+			}
+		}
+	case Instruction::MEMACCESS:
+		accessFunc = &DBInterpreter::processMemAccess;
+		break;
+	case Instruction::ACQUIRE:
+		accessFunc = &DBInterpreter::processAcqAccess;
+		break;
+	case Instruction::RELEASE:
+		accessFunc = &DBInterpreter::processRelAccess;
+		break;
+	case Instruction::FORK:
+	case Instruction::JOIN:
+		{
+			if (row.isNull(24)) {
+				BOOST_LOG_TRIVIAL(error) << "Thread not found: " << ins.instruction_id;
+				return IN_NO_ENTRY;
+			}
+			thread_t thread(row.getInt(24),
+							ins.instruction_id,
+							row.getInt(25),
+							row.getInt(26));
+
+			if (ins.instruction_type == Instruction::FORK)
+				return processFork(ins, segment, call, thread);
+			else
+				return processJoin(ins, segment, call, thread);
+		}
+	default:
+		return IN_NO_ENTRY;
+	}
+
+	// instruction without any access
+	if (row.isNull(14))
+		return IN_NO_ENTRY;
+
+	ACC_ID accessId = row.getInt(14);
+	access_t access(accessId,
+					ins.instruction_id,
+					row.getInt(15),
+					columnText(row, 16),
+					columnText(row, 17),
+					columnText(row, 18));
+
+	if (row.isNull(19)) {
+		BOOST_LOG_TRIVIAL(error) << "Reference not found: " << access.reference_no;
+		return IN_NO_ENTRY;
+	}
+	access.reference_id = row.getInt(19);
+	reference_t reference(columnText(row, 16),
+						  row.getInt(19),
+						  row.getInt(20),
+						  columnText(row, 21),
+						  columnText(row, 22),
+						  row.getInt(23));
+
+	return (this->* accessFunc)(accessId, access, ins, segment, call, reference);
+}
+
 int DBInterpreter::processInstruction(const instruction_t& ins) {
 
+	return processInstruction(ins, accessT_.get(ins.instruction_id));
+}
+
+int DBInterpreter::processInstruction(const instruction_t& ins,
+									  DBIndex<INS_ID, access_t>::Range accesses) {
+
+	if ((instructionEvents(ins.instruction_type) & _events) == 0)
+		return IN_OK;
+
 	processAccess_t accessFunc = nullptr;
 	segment_t* segment = nullptr;
 	call_t* call = nullptr;
 
 	if ( segmentT_.get(ins.segment_id, &segment) == IN_OK) {  
-		switch( transformInstrType(ins) ) {
+		auto callEntry = callT_.find(segment->call_id);
+		if (callEntry != callT_.end()) {
+			auto function = functionT_.find(callEntry->second.function_id);
+			setScope(callEntry->second, function != functionT_.end() ?
+					 function->second.file_id : NO_ID32);
+		}
+
+		switch( ins.instruction_type ) {
 		case Instruction::CALL:
 				processSegment(ins.segment_id, *segment, ins);
 			break;
@@ -153,46 +956,44 @@ int DBInterpreter::processInstruction(const instruction_t& ins) {
 	}			 
 
 	if (accessFunc != nullptr) {
-		auto search = _insAccessMap.find(ins.instruction_id);
-		accessVector_t::iterator it;
-		for (it = search->second.begin(); it != search->second.end(); it++) {
-
-			auto searchAccess = accessT_.find(*it);
-			if (searchAccess != accessT_.end()) {
-
-				processAccessGeneric(search->first,
-									 searchAccess->second,
-									 ins,
-									 *segment,
-									 *call,
-									 accessFunc);
-			} else {
-				BOOST_LOG_TRIVIAL(error) << "Access not found: " << *it;
-				return IN_NO_ENTRY;
-			}
+		if (accesses.empty()) {
+			// all accesses may have been filtered by their memory type
+			if (ins.instruction_type == Instruction::MEMACCESS &&
+				_pushdown.getExcludedMemoryTypes() != 0)
+				return IN_OK;
+			BOOST_LOG_TRIVIAL(error) << "Access not found: " << ins.instruction_id;
+			return IN_NO_ENTRY;
 		}
+
+		for (const auto& access : accesses)
+			processAccessGeneric(access.id,
+								 access,
+								 ins,
+								 *segment,
+								 *call,
+								 accessFunc);
 	}
 
 	return IN_OK;
 }
 
-int DBInterpreter::processSegment(unsigned int segmentId,
+int DBInterpreter::processSegment(SEG_ID segmentId,
 								  const segment_t& seg,
 								  const instruction_t& ins) {
 
 	auto search = callT_.find(seg.call_id);
 	if (search != callT_.end()) {
-		if (!processCall(seg.call_id.c_str(), search->second, seg, ins))
+		if (!processCall(seg.call_id, search->second, seg, ins))
 			return 1;
 	} else {
-		BOOST_LOG_TRIVIAL(error) << "Call not found: " << seg.call_id;
+		BOOST_LOG_TRIVIAL(error) << "Call not found: " << seg.call_no;
 		return 1;
 	}
 
 	return 0;
 }
 
-int DBInterpreter::processCall(const char* callId,
+int DBInterpreter::processCall(CAL_ID callId,
 							   const call_t& call,
 							   const segment_t& seg,
 							   const instruction_t& ins) {
@@ -200,21 +1001,13 @@ int DBInterpreter::processCall(const char* callId,
 	auto search = functionT_.find(call.function_id);
 	if (search != functionT_.end()) {
 
-		switch(function_t::getFunctionType(search->second.type)) {
+		switch(search->second.type) {
 		case Function::FUNCTION:
 		case Function::METHOD:
 		{
 			auto searchFile = fileT_.find(search->second.file_id);
 			if (searchFile != fileT_.end()) {
-				CallInfo info( std::atoi(call.end_time), // todo: use runtime!
-							   search->second.signature,
-							   function_t::getFunctionType(search->second.type),
-							   searchFile->second.file_name,
-							   searchFile->second.file_path);
-
-				ShadowThread* thread = threadMgr_->getThread(call.thread_id);
-				CallEvent event(thread, &info);
-				_eventService->publish(&event);
+				processCall(call, search->second, searchFile->second);
 			} else {
 				BOOST_LOG_TRIVIAL(error) << "File not found: " << search->second.file_id;
 				return 1;
@@ -232,6 +1025,23 @@ int DBInterpreter::processCall(const char* callId,
 	return IN_OK;
 }
 
+int DBInterpreter::processCall(const call_t& call,
+							   const function_t& function,
+							   const file_t& file) {
+
+	CallInfo info( std::atoi(call.end_time), // todo: use runtime!
+				   function.signature,
+				   function.type,
+				   file.file_name,
+				   file.file_path);
+
+	ShadowThread* thread = getShadowThread(call);
+	CallEvent event(thread, &info);
+	_eventService->publish(&event, &_scope);
+
+	return IN_OK;
+}
+
 int DBInterpreter::processAccessGeneric(ACC_ID accessId,
 										const access_t& access,
 										const instruction_t& instruction,
@@ -239,15 +1049,14 @@ int DBInterpreter::processAccessGeneric(ACC_ID accessId,
 										const call_t& call,
 										processAccess_t func) {
 
-	std::string refId = std::string(access.reference_id);
-	auto search = referenceT_.find(_refNoIdMap[refId]);
+	auto search = referenceT_.find(access.reference_id);
 	if ( search != referenceT_.end() ) {
 
 		(this->* func)(accessId, access, instruction, segment,
 					   call, search->second);
 
 	} else {
-		BOOST_LOG_TRIVIAL(error) << "Reference not found: " << access.reference_id;
+		BOOST_LOG_TRIVIAL(error) << "Reference not found: " << access.reference_no;
 
 		return IN_NO_ENTRY;
 	}
@@ -262,25 +1071,13 @@ int DBInterpreter::processMemAccess(ACC_ID accessId,
 									const call_t& call,
 									const reference_t& reference) {
 
-	ShadowVar *var = 0;
-	auto searchVar = _shadowVarMap.find(reference.id);
-	if ( searchVar != _shadowVarMap.end() ) {
-		var = searchVar->second;
-	} else {
-		var = new ShadowVar( getVarType(reference.memory_type),
-								reference.id,
-								//reference.address,
-								reference.size,
-								reference.name);
-		_shadowVarMap[reference.id] = var;
-	}
-
-	ShadowThread* thread = threadMgr_->getThread(call.thread_id);
-	AccessInfo info( access_t::getAccessType(access.access_type),
+	ShadowVar *var = getShadowVar(reference);
+	ShadowThread* thread = getShadowThread(call);
+	AccessInfo info( access.access_type,
 					 var,
 					 instruction.instruction_id);
 	AccessEvent event( thread, &info );
-	_eventService->publish( &event );
+	_eventService->publish( &event, &_scope );
 
 	return 0;
 }
@@ -292,11 +1089,11 @@ int DBInterpreter::processAcqAccess(ACC_ID accessId,
 									const call_t& call,
 									const reference_t& reference) {
 	
-	ShadowThread* thread = threadMgr_->getThread(call.thread_id);
-	ShadowLock *lock = lockMgr_->getLock(std::string(reference.reference_id));
+	ShadowThread* thread = getShadowThread(call);
+	ShadowLock *lock = getShadowLock(reference);
 	AcquireInfo info(lock);					  
 	AcquireEvent event( thread, &info );
-	_eventService->publish( &event );
+	_eventService->publish( &event, &_scope );
 
 	return 0;
 }
@@ -308,11 +1105,11 @@ int DBInterpreter::processRelAccess(ACC_ID accessId,
 									const call_t& call,
 									const reference_t& reference) {
 		
-	ShadowThread* thread = threadMgr_->getThread(call.thread_id);
-	ShadowLock *lock = lockMgr_->getLock(std::string(reference.reference_id));
+	ShadowThread* thread = getShadowThread(call);
+	ShadowLock *lock = getShadowLock(reference);
 	ReleaseInfo info(lock);					  
 	ReleaseEvent event( thread, &info );
-	_eventService->publish( &event );
+	_eventService->publish( &event, &_scope );
 
 	return 0;
 }
@@ -323,11 +1120,11 @@ int DBInterpreter::processFork(const instruction_t& instruction,
 							   const thread_t& thread) {
 		
 
-	ShadowThread *pT = threadMgr_->getThread(call.thread_id);
-	ShadowThread *cT = threadMgr_->getThread(thread.child_thread_id);
+	ShadowThread *pT = getShadowThread(call);
+	ShadowThread *cT = getShadowThread(thread);
 	NewThreadInfo info(cT);					  
 	NewThreadEvent event( pT, &info );
-	_eventService->publish( &event );
+	_eventService->publish( &event, &_scope );
 
 	return 0;
 }
@@ -337,15 +1134,58 @@ int DBInterpreter::processJoin(const instruction_t& instruction,
 							   const call_t& call,
 							   const thread_t& thread) {
 									   
-	ShadowThread *pT = threadMgr_->getThread(call.thread_id);
-	ShadowThread *cT = threadMgr_->getThread(thread.child_thread_id);
+	ShadowThread *pT = getShadowThread(call);
+	ShadowThread *cT = getShadowThread(thread);
 	JoinInfo info(cT);					  
 	JoinEvent event( pT, &info );
-	_eventService->publish( &event );
+	_eventService->publish( &event, &_scope );
 
 	return 0;
 }
 
+// Rows linked by linkShadows carry their shadow entities; rows read while
+// streaming are resolved through the managers.
+ShadowThread* DBInterpreter::getShadowThread(const call_t& call) {
+
+	if (call.thread != nullptr)
+		return call.thread;
+	return threadMgr_->getThread(call.thread_id);
+}
+
+ShadowThread* DBInterpreter::getShadowThread(const thread_t& thread) {
+
+	if (thread.child_thread != nullptr)
+		return thread.child_thread;
+	return threadMgr_->getThread(thread.child_thread_id);
+}
+
+ShadowVar* DBInterpreter::getShadowVar(const reference_t& reference) {
+
+	if (reference.var != nullptr)
+		return reference.var;
+
+	ShadowVar *var = 0;
+	auto searchVar = _shadowVarMap.find(reference.id);
+	if ( searchVar != _shadowVarMap.end() ) {
+		var = searchVar->second;
+	} else {
+		var = new ShadowVar( getVarType(reference.memory_type),
+								reference.id,
+								//reference.address,
+								reference.size,
+								reference.name);
+		_shadowVarMap[reference.id] = var;
+	}
+	return var;
+}
+
+ShadowLock* DBInterpreter::getShadowLock(const reference_t& reference) {
+
+	if (reference.lock != nullptr)
+		return reference.lock;
+	return lockMgr_->getLock(reference.id);
+}
+
 ShadowVar::VarType DBInterpreter::getVarType(REF_MTYP memType) {
 	switch (memType) {
 	case reference_t::LOCAL:
@@ -362,26 +1202,84 @@ ShadowVar::VarType DBInterpreter::getVarType(REF_MTYP memType) {
 	}																	
 }
 
-int DBInterpreter::fillStructures(sqlite3 **db) {
+int DBInterpreter::fillStructures() {
+
+	// The tables do not depend on each other while they load and every fill
+	// function only writes its own table (fillReference also builds
+	// _refNoIdMap and fillCall _callNoIdMap), so each table is read by its
+	// own worker through its own read-only connection. A worker may finish
+	// its table with a post step, such as building the access index.
+	// Tables only needed for events nobody subscribed to are not read, and
+	// predicates all subscribers agree on are applied by SQLite.
+	// The two largest tables are read in rowid ranges by workers of their
+	// own (see fillRanges).
+	typedef int (DBInterpreter::*postFunc_t)();
+	typedef std::string (DBInterpreter::*whereFunc_t)() const;
+	static const int ACCESSES = ACCESS | ACQUIRE | RELEASE;
+	static const struct {
+		const char *table;
+		fillFunc_t func;
+		rangeFunc_t ranged;	// used instead of func
+		postFunc_t post;
+		whereFunc_t where;
+		int events;		// events that need the table
+	} jobs[] = {
+		{ "ACCESS_TABLE", nullptr, &DBInterpreter::fillAccessRanges,
+		  &DBInterpreter::buildAccessIndex, &DBInterpreter::accessWhere, ACCESSES },
+		{ "CALL_TABLE", &DBInterpreter::fillCall, nullptr, nullptr,
+		  &DBInterpreter::callWhere, ALL },
+		{ "FILE_TABLE", &DBInterpreter::fillFile, nullptr, nullptr, nullptr, CALL },
+		{ "FUNCTION_TABLE", &DBInterpreter::fillFunction, nullptr, nullptr, nullptr, CALL },
+		{ "INSTRUCTION_TABLE", nullptr, &DBInterpreter::fillInstructionRanges,
+		  nullptr, &DBInterpreter::instructionWhere, ALL },
+		{ "REFERENCE_TABLE", &DBInterpreter::fillReference, nullptr, nullptr, nullptr, ACCESSES },
+		{ "SEGMENT_TABLE", &DBInterpreter::fillSegment, nullptr, nullptr, nullptr, ALL },
+		{ "THREAD_TABLE", &DBInterpreter::fillThread, nullptr, nullptr, nullptr, NEWTHREAD | JOIN }
+	};
+	static const unsigned nJobs = sizeof(jobs) / sizeof(jobs[0]);
+
+	int results[nJobs];
+	std::string sqls[nJobs];
+	std::string wheres[nJobs];
+	std::vector<std::thread> workers;
+	workers.reserve(nJobs);
+	for (unsigned i = 0; i < nJobs; ++i) {
+		results[i] = 0;
+		bool needed = (jobs[i].events & _events) != 0 ||
+					  (jobs[i].func == &DBInterpreter::fillFunction && _needFiles);
+		if (!needed) {
+			BOOST_LOG_TRIVIAL(trace) << "Skipped (no subscriber): " << jobs[i].table;
+			continue;
+		}
+		// the large tables are streamed by processExternal instead
+		if (_mode == EXTERNAL && jobs[i].ranged != nullptr)
+			continue;
+
+		sqls[i] = std::string("SELECT * from ") + jobs[i].table;
+		wheres[i] = jobs[i].where ? (this->* jobs[i].where)() : "";
+		if (!wheres[i].empty())
+			sqls[i] += " WHERE " + wheres[i];
+		sqls[i] += ";";
+
+		workers.push_back(std::thread([this, i, &results, &sqls, &wheres]() {
+			if (jobs[i].ranged != nullptr)
+				results[i] = (this->* jobs[i].ranged)(wheres[i]);
+			else
+				results[i] = fillTable(jobs[i].table, sqls[i].c_str(), jobs[i].func);
+			if (results[i] == 0 && jobs[i].post != nullptr) {
+				RunReport::Mark start = RunReport::now();
+				results[i] = (this->* jobs[i].post)();
+				if (report_ != nullptr)
+					report_->phase("index", start, accessT_.size());
+			}
+		}));
+	}
 
-	int rc;
+	for (auto& worker : workers)
+		worker.join();
 
-	if ((rc = fillGeneric("SELECT * from ACCESS_TABLE;",
-						  db, &DBInterpreter::fillAccess)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from CALL_TABLE;",
-						  db, &DBInterpreter::fillCall)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from FILE_TABLE;",
-						  db, &DBInterpreter::fillFile)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from FUNCTION_TABLE;",
-						  db, &DBInterpreter::fillFunction)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from INSTRUCTION_TABLE;",
-						  db, &DBInterpreter::fillInstruction)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from REFERENCE_TABLE;",
-						  db, &DBInterpreter::fillReference)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from SEGMENT_TABLE;",
-						  db, &DBInterpreter::fillSegment)) != 0) return rc;
-	if ((rc = fillGeneric("SELECT * from THREAD_TABLE;",
-						  db, &DBInterpreter::fillThread)) != 0) return rc;
+	for (unsigned i = 0; i < nJobs; ++i)
+		if (results[i] != 0) return results[i];
 
 	BOOST_LOG_TRIVIAL(trace) << "Rows in ACCESS_TABLE: " << accessT_.size();
 	BOOST_LOG_TRIVIAL(trace) << "Rows in CALL_TABLE: " << callT_.size();
@@ -391,10 +1289,352 @@ int DBInterpreter::fillStructures(sqlite3 **db) {
 	BOOST_LOG_TRIVIAL(trace) << "Rows in REFERENCE_TABLE: " << referenceT_.size();
 	BOOST_LOG_TRIVIAL(trace) << "Rows in SEGMENT_TABLE: " << segmentT_.size();
 	BOOST_LOG_TRIVIAL(trace) << "Rows in THREAD_TABLE: " << threadT_.size();
+
+	if (report_ != nullptr) {
+		report_->retained("ACCESS_TABLE", footprint(accessT_));
+		report_->retained("CALL_TABLE", footprint(callT_));
+		report_->retained("FILE_TABLE", footprint(fileT_));
+		report_->retained("FUNCTION_TABLE", footprint(functionT_));
+		report_->retained("INSTRUCTION_TABLE", footprint(instructionT_));
+		report_->retained("REFERENCE_TABLE", footprint(referenceT_));
+		report_->retained("SEGMENT_TABLE", footprint(segmentT_));
+		report_->retained("THREAD_TABLE", footprint(threadT_));
+	}
 	return 0;
 }
 
-int DBInterpreter::fillGeneric(const char *sql, sqlite3 **db, fillFunc_t func) {
+// Comma separated ids for an IN clause.
+static std::string idList(const Filter::IdSet& ids) {
+
+	std::string list;
+	for (auto id : ids) {
+		if (!list.empty())
+			list += ", ";
+		list += std::to_string(id);
+	}
+	return list;
+}
+
+std::string DBInterpreter::callPredicate(const char *call) const {
+
+	std::string predicate;
+	auto add = [&predicate](const std::string& term) {
+		if (!predicate.empty())
+			predicate += " AND ";
+		predicate += term;
+	};
+
+	if (!_pushdown.getThreads().empty())
+		add(std::string(call) + "thread_id IN (" +
+			idList(_pushdown.getThreads()) + ")");
+	if (!_pushdown.getFunctions().empty())
+		add(std::string(call) + "function_id IN (" +
+			idList(_pushdown.getFunctions()) + ")");
+	if (!_pushdown.getFiles().empty())
+		add(std::string(call) + "function_id IN (SELECT id FROM FUNCTION_TABLE"
+			" WHERE file_id IN (" + idList(_pushdown.getFiles()) + "))");
+	return predicate;
+}
+
+std::string DBInterpreter::memoryPredicate(const char *reference) const {
+
+	static const struct {
+		ShadowVar::VarType type;
+		REF_MTYP code;
+	} codes[] = {
+		{ ShadowVar::STACK, reference_t::LOCAL },
+		{ ShadowVar::GLOBAL, reference_t::GLOBAL },
+		{ ShadowVar::HEAP, reference_t::HEAP },
+		{ ShadowVar::STATIC, reference_t::STATIC }
+	};
+
+	std::string excluded;
+	for (const auto& code : codes) {
+		if (_pushdown.acceptsMemoryType(code.type))
+			continue;
+		if (!excluded.empty())
+			excluded += ", ";
+		excluded += std::string("'") + code.code + "'";
+	}
+
+	if (excluded.empty())
+		return excluded;
+	return std::string(reference) + "memory_type NOT IN (" + excluded + ")";
+}
+
+std::string DBInterpreter::callWhere() const {
+	return callPredicate("");
+}
+
+std::string DBInterpreter::instructionWhere() const {
+
+	std::string calls = callPredicate("c.");
+	if (calls.empty())
+		return calls;
+	return "segment_id IN (SELECT s.id FROM SEGMENT_TABLE s"
+		   " JOIN CALL_TABLE c ON c.id = s.call_id WHERE " + calls + ")";
+}
+
+std::string DBInterpreter::accessWhere() const {
+
+	std::string where;
+	std::string calls = callPredicate("c.");
+	if (!calls.empty())
+		where = "instruction_id IN (SELECT i.id FROM INSTRUCTION_TABLE i"
+				" JOIN SEGMENT_TABLE s ON s.id = i.segment_id"
+				" JOIN CALL_TABLE c ON c.id = s.call_id WHERE " + calls + ")";
+
+	// the memory type only restricts memory accesses, not lock accesses
+	std::string memory = memoryPredicate("r.");
+	if (!memory.empty()) {
+		if (!where.empty())
+			where += " AND ";
+		where += "(reference_id IN (SELECT r.reference_id FROM REFERENCE_TABLE r"
+				 " WHERE " + memory + ") OR instruction_id IN (SELECT id FROM"
+				 " INSTRUCTION_TABLE WHERE instruction_type <> 'ACCESS'))";
+	}
+	return where;
+}
+
+void DBInterpreter::setScope(const call_t& call, FIL_ID fileId) {
+
+	_scope.thread = call.thread_id;
+	_scope.function = call.function_id;
+	_scope.file = fileId;
+}
+
+int DBInterpreter::fillTable(const char *table, const char *sql, fillFunc_t func) {
+
+	sqlite3 *db;
+	if ( loadDB(_dbPath, &db) != IN_OK )
+		return IN_ABORT;
+
+	int rc = fillGeneric(table, sql, &db, func);
+	closeDB(&db);
+	return rc;
+}
+
+int DBInterpreter::linkStructures() {
+
+	// segment -> call
+	for (auto& segment : segmentT_) {
+		auto search = _callNoIdMap.find(segment.second.call_no);
+		if (search != _callNoIdMap.end())
+			segment.second.call_id = search->second;
+	}
+
+	// access -> reference
+	for (auto& access : accessT_) {
+		auto search = _refNoIdMap.find(access.reference_no);
+		if (search != _refNoIdMap.end())
+			access.reference_id = search->second;
+	}
+
+	// the string keys are not needed while events are dispatched, except
+	// for resolving the references of accesses read by processExternal
+	callNoIdMap_t().swap(_callNoIdMap);
+	if (_mode != EXTERNAL)
+		refNoIdMap_t().swap(_refNoIdMap);
+
+	return IN_OK;
+}
+
+int DBInterpreter::linkShadows() {
+
+	// Walk the instructions in interpretation order so that the managers
+	// hand out thread and lock ids in the same order as they would while
+	// publishing.
+	for (const auto& instruction : instructionT_)
+		linkInstruction(instruction.second);
+
+	return IN_OK;
+}
+
+void DBInterpreter::linkInstruction(const instruction_t& ins) {
+
+	if ((instructionEvents(ins.instruction_type) & _events) == 0)
+		return;
+
+	auto segment = segmentT_.find(ins.segment_id);
+	if (segment == segmentT_.end())
+		return;
+
+	auto callEntry = callT_.find(segment->second.call_id);
+	if (callEntry == callT_.end())
+		return;
+
+	call_t& call = callEntry->second;
+	switch( ins.instruction_type ) {
+	case Instruction::CALL:
+		{
+			auto function = functionT_.find(call.function_id);
+			if (function != functionT_.end() &&
+				(function->second.type == Function::FUNCTION ||
+				 function->second.type == Function::METHOD) &&
+				fileT_.find(function->second.file_id) != fileT_.end())
+				call.thread = getShadowThread(call);
+			break;
+		}
+	case Instruction::MEMACCESS:
+	case Instruction::ACQUIRE:
+	case Instruction::RELEASE:
+		{
+			for (const auto& access : accessT_.get(ins.instruction_id)) {
+				auto reference = referenceT_.find(access.reference_id);
+				if (reference == referenceT_.end())
+					continue;
+
+				if (ins.instruction_type == Instruction::MEMACCESS) {
+					reference->second.var = getShadowVar(reference->second);
+					call.thread = getShadowThread(call);
+				} else {
+					call.thread = getShadowThread(call);
+					reference->second.lock = getShadowLock(reference->second);
+				}
+			}
+			break;
+		}
+	case Instruction::FORK:
+	case Instruction::JOIN:
+		{
+			auto thread = threadT_.find(ins.instruction_id);
+			if (thread != threadT_.end()) {
+				call.thread = getShadowThread(call);
+				thread->second.child_thread = getShadowThread(thread->second);
+			}
+			break;
+		}
+	default:
+		break;
+	}
+}
+
+int DBInterpreter::writeCache(const char *path,
+							  const TraceCache::Source& source) {
+
+	// string heap, shared by equal views
+	std::vector<char> heap;
+	std::unordered_map<const char*, uint32_t> heapOffsets;
+	auto heapOffset = [&heap, &heapOffsets](const char *str) -> uint32_t {
+		auto search = heapOffsets.find(str);
+		if (search != heapOffsets.end())
+			return search->second;
+		uint32_t offset = heap.size();
+		heap.insert(heap.end(), str, str + strlen(str) + 1);
+		heapOffsets[str] = offset;
+		return offset;
+	};
+
+	// instructions in interpretation order with their access slices
+	std::vector<INS_ID> insId;
+	std::vector<uint8_t> insType;
+	std::vector<CAL_ID> insCall;
+	std::vector<TRD_TID> insChild;
+	std::vector<ACC_ID> insAccesses(1, 0);
+	std::vector<ACC_ID> accId;
+	std::vector<REF_ID> accReference;
+	std::vector<uint8_t> accType;
+
+	for (const auto& entry : instructionT_) {
+		const instruction_t& ins = entry.second;
+		auto segment = segmentT_.find(ins.segment_id);
+		auto thread = threadT_.find(ins.instruction_id);
+
+		insId.push_back(ins.instruction_id);
+		insType.push_back(ins.instruction_type);
+		insCall.push_back(segment != segmentT_.end() ?
+						  segment->second.call_id : NO_ID32);
+		insChild.push_back(thread != threadT_.end() ?
+						   thread->second.child_thread_id : NO_ID32);
+
+		for (const auto& access : accessT_.get(ins.instruction_id)) {
+			accId.push_back(access.id);
+			accReference.push_back(access.reference_id);
+			accType.push_back(access.access_type);
+		}
+		insAccesses.push_back(accId.size());
+	}
+
+	// calls (dense CAL_IDs)
+	std::vector<TRD_TID> callThread;
+	std::vector<FUN_ID> callFunction;
+	std::vector<int32_t> callRuntime;
+	for (const auto& entry : callT_) {
+		callThread.push_back(entry.second.thread_id);
+		callFunction.push_back(entry.second.function_id);
+		callRuntime.push_back(std::atoi(entry.second.end_time));
+	}
+
+	// functions, files and references indexed by id
+	std::vector<uint8_t> fnType;
+	std::vector<uint32_t> fnSignature;
+	std::vector<FIL_ID> fnFile;
+	for (const auto& entry : functionT_) {
+		fnType.resize(entry.first + 1, TraceCache::NO_TYPE);
+		fnSignature.resize(entry.first + 1, TraceCache::NO_STRING);
+		fnFile.resize(entry.first + 1, NO_ID32);
+		fnType[entry.first] = entry.second.type;
+		fnSignature[entry.first] = heapOffset(entry.second.signature);
+		fnFile[entry.first] = entry.second.file_id;
+	}
+
+	std::vector<uint32_t> fileName, filePath;
+	for (const auto& entry : fileT_) {
+		fileName.resize(entry.first + 1, TraceCache::NO_STRING);
+		filePath.resize(entry.first + 1, TraceCache::NO_STRING);
+		fileName[entry.first] = heapOffset(entry.second.file_name);
+		filePath[entry.first] = heapOffset(entry.second.file_path);
+	}
+
+	std::vector<uint8_t> refType;
+	std::vector<REF_SIZE> refSize;
+	std::vector<uint32_t> refName;
+	for (const auto& entry : referenceT_) {
+		refType.resize(entry.first + 1, TraceCache::NO_TYPE);
+		refSize.resize(entry.first + 1, 0);
+		refName.resize(entry.first + 1, TraceCache::NO_STRING);
+		refType[entry.first] = getVarType(entry.second.memory_type);
+		refSize[entry.first] = entry.second.size;
+		refName[entry.first] = heapOffset(entry.second.name);
+	}
+
+	// heap offsets are 32 bit, with NO_STRING reserved
+	if (heap.size() >= TraceCache::NO_STRING) {
+		BOOST_LOG_TRIVIAL(error) << "Can't write trace cache " << path
+								 << ": string heap exceeds 4 GiB";
+		return IN_ABORT;
+	}
+
+	TraceCacheWriter writer(path, source);
+	writer.write(TraceCache::INSTRUCTION_ID, insId);
+	writer.write(TraceCache::INSTRUCTION_TYPE, insType);
+	writer.write(TraceCache::INSTRUCTION_CALL, insCall);
+	writer.write(TraceCache::INSTRUCTION_CHILD, insChild);
+	writer.write(TraceCache::INSTRUCTION_ACCESSES, insAccesses);
+	writer.write(TraceCache::ACCESS_ID, accId);
+	writer.write(TraceCache::ACCESS_REFERENCE, accReference);
+	writer.write(TraceCache::ACCESS_TYPE, accType);
+	writer.write(TraceCache::CALL_THREAD, callThread);
+	writer.write(TraceCache::CALL_FUNCTION, callFunction);
+	writer.write(TraceCache::CALL_RUNTIME, callRuntime);
+	writer.write(TraceCache::FUNCTION_TYPE, fnType);
+	writer.write(TraceCache::FUNCTION_SIGNATURE, fnSignature);
+	writer.write(TraceCache::FUNCTION_FILE, fnFile);
+	writer.write(TraceCache::FILE_NAME, fileName);
+	writer.write(TraceCache::FILE_PATH, filePath);
+	writer.write(TraceCache::REFERENCE_TYPE, refType);
+	writer.write(TraceCache::REFERENCE_SIZE, refSize);
+	writer.write(TraceCache::REFERENCE_NAME, refName);
+	writer.write(TraceCache::STRING_HEAP, heap);
+
+	int rc = writer.close();
+	if (rc == IN_OK)
+		BOOST_LOG_TRIVIAL(trace) << "Wrote trace cache " << path;
+	return rc;
+}
+
+int DBInterpreter::fillGeneric(const char *table, const char *sql, sqlite3 **db,
+							   fillFunc_t func) {
 
    sqlite3_stmt *sqlstmt = 0;
 
@@ -404,164 +1644,293 @@ int DBInterpreter::fillGeneric(const char *sql, sqlite3 **db, fillFunc_t func) {
 	   return 1;
    }
 
+   int rc = stepRows(table, sql, *db, sqlstmt, [this, func](sqlite3_stmt *stmt) {
+	   return (this->* func)(stmt);
+   });
+   sqlite3_finalize(sqlstmt);
+   return rc;
+}
+
+template<typename Decode>
+int DBInterpreter::stepRows(const char *table, const char *sql, sqlite3 *db,
+							sqlite3_stmt *sqlstmt, Decode decode) {
+
+   auto start = std::chrono::steady_clock::now();
+   unsigned long rows = 0, bytes = 0;
+
+   int rc = 0;
    bool reading = true;
    while (reading) {
 	   switch(sqlite3_step(sqlstmt)) {
 	   case SQLITE_ROW:
-		   (this->* func)(sqlstmt);
+		   if (report_ != nullptr)	// before decoding converts any column
+			   bytes += rowBytes(sqlstmt);
+		   if (decode(sqlstmt) == IN_ABORT) {
+			   rc = IN_ABORT;
+			   reading = false;
+		   }
+		   ++rows;
 		   break;
 	   case SQLITE_DONE:
 		   reading = false;
 		   break;
 	   default:
-		   BOOST_LOG_TRIVIAL(trace) << "Iterating db failed!";
-		   return 2;
+		   BOOST_LOG_TRIVIAL(trace) << "Iterating db failed: " << sqlite3_errmsg(db);
+		   rc = 2;
+		   reading = false;
+		   break;
 	   }
    }
 
-   return 0;
+   double seconds = std::chrono::duration<double>(
+		   std::chrono::steady_clock::now() - start).count();
+   BOOST_LOG_TRIVIAL(trace) << "Read " << rows << " rows in " << seconds << " s ("
+							<< (seconds > 0 ? rows / seconds : 0) << " rows/s): "
+							<< sql;
+   if (report_ != nullptr) {
+	   report_->table(table, rows, bytes, start);
+	   _loadedRows += rows;
+	   _loadedBytes += bytes;
+   }
+   return rc;
 }
 
-int DBInterpreter::fillAccess(sqlite3_stmt *sqlstmt) {
+// Tables below this many rows per worker are read in one range.
+static const sqlite3_int64 kMinRangeRows = 1 << 16;
+
+// Splits the rowids of a table into ranges that workers decode in parallel,
+// each through its own read-only connection into a table of its own. The
+// partial tables are then appended to the target in rowid order, so the
+// result equals that of a single scan.
+template<typename TableT>
+int DBInterpreter::fillRanges(const char *table, const std::string& where,
+							  TableT *target, int (*decode)(sqlite3_stmt*, TableT*)) {
+
+	sqlite3 *db;
+	if ( loadDB(_dbPath, &db) != IN_OK )
+		return IN_ABORT;
+
+	sqlite3_int64 first = 0, last = -1;
+	sqlite3_stmt *bounds = 0;
+	std::string sql = std::string("SELECT MIN(rowid), MAX(rowid) FROM ") + table + ";";
+	if (sqlite3_prepare_v2(db, sql.c_str(), -1, &bounds, NULL) == SQLITE_OK &&
+		sqlite3_step(bounds) == SQLITE_ROW &&
+		sqlite3_column_type(bounds, 0) != SQLITE_NULL) {
+		first = sqlite3_column_int64(bounds, 0);
+		last = sqlite3_column_int64(bounds, 1);
+	}
+	sqlite3_finalize(bounds);
+	closeDB(&db);
 
-   ACC_ID id = sqlite3_column_int(sqlstmt, 0);
-   INS_ID instruction_id = sqlite3_column_int(sqlstmt, 1);
+	sqlite3_int64 ranges = std::min<sqlite3_int64>(
+		std::max(1u, std::thread::hardware_concurrency()),
+		(last - first + 1) / kMinRangeRows);
+	ranges = std::max<sqlite3_int64>(ranges, 1);
+	sqlite3_int64 span = (last - first + ranges) / ranges;
+
+	sql = std::string("SELECT * FROM ") + table + " WHERE ";
+	if (!where.empty())
+		sql += "(" + where + ") AND ";
+	sql += "rowid BETWEEN ?1 AND ?2;";
+
+	std::vector<std::unique_ptr<TableT>> parts(ranges);
+	std::vector<int> results(ranges, 0);
+	std::vector<std::thread> workers;
+	for (sqlite3_int64 r = 0; r < ranges; ++r) {
+		if (r > 0)
+			parts[r].reset(new TableT());
+		TableT *part = r > 0 ? parts[r].get() : target;
+		sqlite3_int64 from = first + r * span;
+		sqlite3_int64 to = std::min(last, from + span - 1);
+
+		workers.push_back(std::thread([this, table, &sql, &results, r, part, from, to,
+									   decode]() {
+			sqlite3 *db;
+			sqlite3_stmt *sqlstmt = 0;
+			if ( loadDB(_dbPath, &db) != IN_OK ) {
+				results[r] = IN_ABORT;
+				return;
+			}
+			if (sqlite3_prepare_v2(db, sql.c_str(), -1, &sqlstmt, NULL) != SQLITE_OK) {
+				BOOST_LOG_TRIVIAL(error) << "Error preparing db: " << sqlite3_errmsg(db);
+				results[r] = 1;
+			} else {
+				sqlite3_bind_int64(sqlstmt, 1, from);
+				sqlite3_bind_int64(sqlstmt, 2, to);
+				results[r] = stepRows(table, sql.c_str(), db, sqlstmt,
+									  [part, decode](sqlite3_stmt *stmt) {
+					return decode(stmt, part);
+				});
+			}
+			sqlite3_finalize(sqlstmt);
+			closeDB(&db);
+		}));
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	for (sqlite3_int64 r = 0; r < ranges; ++r) {
+		if (results[r] != 0)
+			return results[r];
+		if (r > 0)
+			target->absorb(*parts[r]);
+	}
+	return 0;
+}
+
+int DBInterpreter::fillAccessRanges(const std::string& where) {
+
+	return fillRanges("ACCESS_TABLE", where, &accessT_, &DBInterpreter::fillAccess);
+}
+
+int DBInterpreter::fillInstructionRanges(const std::string& where) {
+
+	return fillRanges("INSTRUCTION_TABLE", where, &instructionT_,
+					  &DBInterpreter::fillInstruction);
+}
+
+int DBInterpreter::fillAccess(sqlite3_stmt *sqlstmt,
+							  DBIndex<INS_ID, access_t> *table) {
+
+   ACC_ID id = sqlite3_column_int64(sqlstmt, 0);
+   INS_ID instruction_id = sqlite3_column_int64(sqlstmt, 1);
    int position = sqlite3_column_int(sqlstmt, 2);
-   const unsigned char *reference_id = sqlite3_column_text(sqlstmt, 3);
-   const unsigned char *access_type = sqlite3_column_text(sqlstmt, 4);
-   const unsigned char *memory_state = sqlite3_column_text(sqlstmt, 5);
-
-   access_t *tmp = new access_t(instruction_id,
-		   	   	   	   	   	     position,
-		   	   	   	   	   	     reference_id,
-		   	   	   	   	   	     access_type,
-		   	   	   	   	   	     memory_state); 
-
-   accessT_.fill(id, *tmp);		 
-   _insAccessMap[instruction_id].push_back(id); // create 1:n associations 
+   REF_NO reference_no = table->strings().intern(columnText(sqlstmt, 3));
+   const char *access_type = columnText(sqlstmt, 4);
+   const char *memory_state = table->strings().intern(columnText(sqlstmt, 5));
+
+   table->emplace(instruction_id, // create 1:n associations
+					id,
+					instruction_id,
+					position,
+					reference_no,
+					access_type,
+					memory_state);
    return 0;
 }
 
+int DBInterpreter::buildAccessIndex() {
+
+	return accessT_.build([](const access_t& lhs, const access_t& rhs) {
+		return lhs.position < rhs.position;
+	});
+}
+
 int DBInterpreter::fillCall(sqlite3_stmt *sqlstmt) {
 
-   const unsigned char *id = sqlite3_column_text(sqlstmt, 0);
+   CAL_NO call_no = callT_.strings().store(columnText(sqlstmt, 0));
+   CAL_ID id = callT_.size(); // dense id in load order
    int process_id = sqlite3_column_int(sqlstmt, 1);
    int thread_id = sqlite3_column_int(sqlstmt, 2);
    int function_id = sqlite3_column_int(sqlstmt, 3);
-   int instruction_id = sqlite3_column_int(sqlstmt, 4);
+   INS_ID instruction_id = sqlite3_column_int64(sqlstmt, 4);
    const unsigned char *start_time = sqlite3_column_text(sqlstmt, 5);
    const unsigned char *end_time = sqlite3_column_text(sqlstmt, 6);
 
-   call_t *tmp = new call_t(process_id,
-							thread_id,
-							function_id,
-							instruction_id,
-							start_time,
-							end_time);
-
-   callT_.fill(std::string((const char*)id), *tmp);		 
+   callT_.emplace(id,
+					process_id,
+					thread_id,
+					function_id,
+					instruction_id,
+					start_time,
+					end_time);
+   _callNoIdMap.insert(std::make_pair(call_no, id)); // keep the first id
    return 0;
 }
 
 int DBInterpreter::fillFile(sqlite3_stmt *sqlstmt) {
 
    int id = sqlite3_column_int(sqlstmt, 0);
-   const unsigned char *file_name = sqlite3_column_text(sqlstmt, 1);
-   const unsigned char *file_path = sqlite3_column_text(sqlstmt, 2);
-
-   file_t *tmp = new file_t(file_name,
-		   	   	   	   	   	file_path);
+   const char *file_name = fileT_.strings().store(columnText(sqlstmt, 1));
+   const char *file_path = fileT_.strings().intern(columnText(sqlstmt, 2));
 
-   fileT_.fill(id, *tmp);	 
+   fileT_.emplace(id,
+					file_name,
+					file_path);
    return 0;
 }
 
 int DBInterpreter::fillFunction(sqlite3_stmt *sqlstmt) {
 
    int id = sqlite3_column_int(sqlstmt, 0);
-   const unsigned char *signature = sqlite3_column_text(sqlstmt, 1);
-   const unsigned char *type = sqlite3_column_text(sqlstmt, 2);
+   const char *signature = functionT_.strings().store(columnText(sqlstmt, 1));
+   const char *type = columnText(sqlstmt, 2);
    int file_id = sqlite3_column_int(sqlstmt, 3);
 
-   function_t *tmp = new function_t(signature,
-		   	   	   	  	   	   	    type,
-		   	   	   	   	   	   	    file_id);
-
-   functionT_.fill(id, *tmp);
+   functionT_.emplace(id,
+					signature,
+					type,
+					file_id);
    return 0;
 }
 
-int DBInterpreter::fillInstruction(sqlite3_stmt *sqlstmt) {
+int DBInterpreter::fillInstruction(sqlite3_stmt *sqlstmt,
+								   DBTable<INS_ID, instruction_t> *table) {
 
-   int id = sqlite3_column_int(sqlstmt, 0);
-   int segment_id = sqlite3_column_int(sqlstmt, 1);
-   const unsigned char *instruction_type = sqlite3_column_text(sqlstmt, 2);
+   INS_ID id = sqlite3_column_int64(sqlstmt, 0);
+   SEG_ID segment_id = sqlite3_column_int64(sqlstmt, 1);
+   const char *instruction_type = columnText(sqlstmt, 2);
    int line_number = sqlite3_column_int(sqlstmt, 3);
 
-   instruction_t *tmp = new instruction_t(id,
-										  segment_id,
-										  instruction_type,
-										  line_number);
-
-   instructionT_.fill(id, *tmp);
+   table->emplace(id,
+					id,
+					segment_id,
+					instruction_type,
+					line_number);
    return 0;
 }
 
 int DBInterpreter::fillReference(sqlite3_stmt *sqlstmt) {
 
-   int id = sqlite3_column_int(sqlstmt, 0);
-   const unsigned char *reference_id = sqlite3_column_text(sqlstmt, 1);
+   REF_ID id = sqlite3_column_int64(sqlstmt, 0);
+   REF_NO reference_no = referenceT_.strings().store(columnText(sqlstmt, 1));
    //int address = sqlite3_column_int(sqlstmt, 2);
    int size = sqlite3_column_int(sqlstmt, 2);
-   const unsigned char *memory_type = sqlite3_column_text(sqlstmt, 3);
-   const unsigned char *name = sqlite3_column_text(sqlstmt, 4);
-   int allocinstr = sqlite3_column_int(sqlstmt, 5);
-
-   reference_t *tmp = new reference_t(reference_id,
-		   	   	   	   	   	   	   	  id,
-		   	   	   	   	   	   	   	  //address,
-		   	   	   	   	   	   	   	  size,
-		   	   	   	   	   	   	   	  memory_type,
-		   	   	   	   	   	   	   	  name,
-		   	   	   	   	   	   	   	  allocinstr);
+   const char *memory_type = columnText(sqlstmt, 3);
+   const char *name = referenceT_.strings().store(columnText(sqlstmt, 4));
+   INS_ID allocinstr = sqlite3_column_int64(sqlstmt, 5);
 
-   referenceT_.fill(id, *tmp);
+   referenceT_.emplace(id,
+					reference_no,
+					id,
+					size,
+					memory_type,
+					name,
+					allocinstr);
 
-   REF_NO no = REF_NO((const char*)reference_id);
-   _refNoIdMap[no] = id; // create association between no and id
+   _refNoIdMap[reference_no] = id; // create association between no and id
 
    return 0;
 }
 
 int DBInterpreter::fillSegment(sqlite3_stmt *sqlstmt) {
 
-   int id = sqlite3_column_int(sqlstmt, 0);
-   const unsigned char *call_id = sqlite3_column_text(sqlstmt, 1);
+   SEG_ID id = sqlite3_column_int64(sqlstmt, 0);
+   CAL_NO call_no = segmentT_.strings().store(columnText(sqlstmt, 1));
    int segment_no = sqlite3_column_int(sqlstmt, 2);
    const unsigned char *segment_type = sqlite3_column_text(sqlstmt, 3);
    int loop_pointer = sqlite3_column_int(sqlstmt, 4);
 
-   segment_t *tmp = new segment_t(call_id,
-		   	   	   	   	   	   	  segment_no,
-		   	   	   	   	   	   	  segment_type,
-		   	   	   	   	   	   	  loop_pointer);
-
-   segmentT_.fill(id, *tmp);
+   segmentT_.emplace(id,
+					call_no,
+					segment_no,
+					segment_type,
+					loop_pointer);
    return 0;
 }
 
 int DBInterpreter::fillThread(sqlite3_stmt *sqlstmt) {
 
    int id = sqlite3_column_int(sqlstmt, 0);
-   int instruction_id = sqlite3_column_int(sqlstmt, 1);
+   INS_ID instruction_id = sqlite3_column_int64(sqlstmt, 1);
    int parent_thread_id = sqlite3_column_int(sqlstmt, 2);
    int child_thread_id = sqlite3_column_int(sqlstmt, 3);
 
-   thread_t *tmp = new thread_t(id,
-		   	   	   	   	   	   	instruction_id,
-		   	   	   	   	   	   	parent_thread_id,
-		   	   	   	   	   	   	child_thread_id);
-
-   threadT_.fill(instruction_id, *tmp);
+   threadT_.emplace(instruction_id,
+					id,
+					instruction_id,
+					parent_thread_id,
+					child_thread_id);
    return 0;
 }
@@ -9,15 +9,22 @@
 #define DBINTERPRETER_H_
 
 #include <sqlite3.h>
+#include <atomic>
 #include <map>
 #include <vector>
+#include <unordered_map>
+#include <string>
 #include <string.h>
 #include "Interpreter.h"
 #include "EventService.h"
+#include "Filter.h"
 #include "ShadowThread.h"
 #include "ShadowVar.h"
 #include "DBDataModel.h"
 #include "DBTable.h"
+#include "DBIndex.h"
+#include "StringArena.h"
+#include "TraceCache.h"
 
 class LockMgr;
 class ThreadMgr;
@@ -27,16 +34,68 @@ class ThreadMgr;
  *****************************************************************************/
 class DBInterpreter : public Interpreter {
 public:
+	typedef enum { LOAD,	// load all tables into memory, then interpret
+				   STREAM,	// interpret rows of one joined, ordered cursor
+				   TAIL,	// STREAM in batches while the trace is written
+				   EXTERNAL	// LOAD, but accesses are sorted through spill files
+				 } Mode;
+
+	// SQLite settings applied to every connection that reads the trace
+	typedef struct ReadProfile {
+		sqlite3_int64 mmapSize;	// PRAGMA mmap_size in bytes (0 = read())
+		int cacheSize;			// PRAGMA cache_size (< 0: in KiB)
+		int tempStore;			// PRAGMA temp_store (1 = file, 2 = memory)
+		bool queryOnly;			// PRAGMA query_only
+
+		// profile suited to a database of dbSize bytes
+		static ReadProfile forSize(sqlite3_int64 dbSize);
+	} ReadProfile;
+
+	// polling of a trace database that is still being written (TAIL mode)
+	typedef struct TailProfile {
+		unsigned batchSize;		// instructions interpreted per read
+		unsigned pollInterval;	// ms to wait for new rows once caught up
+		unsigned idleTimeout;	// ms without new rows before finishing
+		const char *endMarker;	// table the writer creates when it is done
+
+		static TailProfile defaults();
+	} TailProfile;
+
 	DBInterpreter(const char* DBPath, const char* logFile, 
-				  EventService *service, LockMgr *lockMgr, ThreadMgr *threadMgr);
+				  EventService *service, LockMgr *lockMgr, ThreadMgr *threadMgr,
+				  Mode mode = LOAD);
 	int process() override;
 	EventService* getEventService() override;
 	~DBInterpreter();
 
+	// write the loaded tables to a trace cache (see MmapInterpreter); LOAD
+	// mode of a single database only
+	void setCacheFile(const char* cacheFile) { _cacheFile = cacheFile; }
+
+	// override the profile chosen from the database size
+	void setReadProfile(const ReadProfile& profile);
+
+	void setTailProfile(const TailProfile& profile) { _tailProfile = profile; }
+
+	// memory for the accesses in EXTERNAL mode, and where runs are spilled
+	void setSpillBudget(size_t bytes, const char* directory) {
+		_spillBudget = bytes;
+		_spillDirectory = directory;
+	}
+
+	// interpret another shard of the trace, merged by instruction id
+	void addShard(const char* shardPath) { _shards.push_back(shardPath); }
+
+	// Shards are time slices of one process by default: an instruction id,
+	// thread id or REF_NO means the same instruction, thread or variable in
+	// every shard. Disjoint shards (one per process) share none of them.
+	void setDisjointShards(bool disjoint) { _disjointShards = disjoint; }
+
 private:
 
 	// types-------------------------------------------------------------------
 	typedef int (DBInterpreter::*fillFunc_t)(sqlite3_stmt*);
+	typedef int (DBInterpreter::*rangeFunc_t)(const std::string& where);
 	typedef int (DBInterpreter::*processAccess_t)(ACC_ID accessID,
 												  const access_t& access,
 												  const instruction_t& instruction,
@@ -44,53 +103,109 @@ private:
 												  const call_t& call,
 												  const reference_t& reference);
 
-	typedef std::vector<ACC_ID> accessVector_t;
-	typedef std::map<INS_ID, accessVector_t> insAccessMap_t;
-	typedef std::map<REF_NO, REF_ID> refNoIdMap_t;
+	typedef std::unordered_map<REF_NO, REF_ID, StringArena::CStrHash,
+							   StringArena::CStrEqual> refNoIdMap_t;
+	typedef std::unordered_map<CAL_NO, CAL_ID, StringArena::CStrHash,
+							   StringArena::CStrEqual> callNoIdMap_t;
 	typedef std::map<REF_ID, ShadowVar*> shadowVarMap_t;
 
 	// members-----------------------------------------------------------------
-	DBTable<ACC_ID, access_t> accessT_;
+	DBIndex<INS_ID, access_t> accessT_;	// accesses grouped by instruction
 	DBTable<CAL_ID, call_t> callT_;
 	DBTable<FIL_ID, file_t> fileT_;
 	DBTable<FUN_ID, function_t> functionT_;
 	DBTable<INS_ID, instruction_t> instructionT_;
 	DBTable<REF_ID, reference_t> referenceT_;
 	DBTable<SEG_ID, segment_t> segmentT_; 
-	DBTable<INS_ID, thread_t> threadT_;
+	DBTable<INS_ID, thread_t, false> threadT_;	// keyed by the fork instruction
 
-	insAccessMap_t _insAccessMap;
 	refNoIdMap_t _refNoIdMap;
+	callNoIdMap_t _callNoIdMap;
 	const char* _dbPath;
+	std::vector<const char*> _shards;	// besides _dbPath
+	bool _disjointShards;
 	const char* _logFile;
+	const char* _cacheFile;
+	const Mode _mode;
+	ReadProfile _readProfile;
+	bool _autoProfile;
+	TailProfile _tailProfile;
+	size_t _spillBudget;
+	const char* _spillDirectory;
+	int _events;	// union of the subscribed events
+	bool _needFiles;	// FUNCTION_TABLE is read to scope events by file
+	Filter _pushdown;	// predicates all subscribers agree on
+	Filter::Scope _scope;	// scope of the instruction being interpreted
 	EventService *_eventService;
 	shadowVarMap_t _shadowVarMap;
+	std::atomic<unsigned long> _loadedRows;		// decoded by fillStructures
+	std::atomic<unsigned long> _loadedBytes;
 
 	// private methods---------------------------------------------------------
-	static Instruction::type transformInstrType(const instruction_t& ins);
 	static ShadowVar::VarType getVarType(REF_MTYP memType);
 
 	int loadDB(const char* path, sqlite3 **db);
 	int closeDB(sqlite3 **db);
-	int fillStructures(sqlite3 **db);
-	int fillGeneric(const char *sql, sqlite3 **db, fillFunc_t func);
-	int fillAccess(sqlite3_stmt *stmt);
+	int fillStructures();
+	std::string callPredicate(const char *call) const;
+	std::string memoryPredicate(const char *reference) const;
+	std::string accessWhere() const;
+	std::string callWhere() const;
+	std::string instructionWhere() const;
+	std::string streamQuery(bool bounded) const;
+	void setScope(const call_t& call, FIL_ID fileId);
+	int fillTable(const char *table, const char *sql, fillFunc_t func);
+	int buildAccessIndex();
+	int linkStructures();
+	int linkShadows();
+	int writeCache(const char *path, const TraceCache::Source& source);
+	void linkInstruction(const instruction_t& instruction);
+
+	ShadowThread* getShadowThread(const call_t& call);
+	ShadowThread* getShadowThread(const thread_t& thread);
+	ShadowVar* getShadowVar(const reference_t& reference);
+	ShadowLock* getShadowLock(const reference_t& reference);
+	int fillGeneric(const char *table, const char *sql, sqlite3 **db,
+					fillFunc_t func);
+	template<typename Decode>
+	int stepRows(const char *table, const char *sql, sqlite3 *db,
+				 sqlite3_stmt *stmt, Decode decode);
+	template<typename TableT>
+	int fillRanges(const char *table, const std::string& where, TableT *target,
+				   int (*decode)(sqlite3_stmt*, TableT*));
+	int fillAccessRanges(const std::string& where);
+	int fillInstructionRanges(const std::string& where);
+	static int fillAccess(sqlite3_stmt *stmt, DBIndex<INS_ID, access_t> *table);
 	int fillCall(sqlite3_stmt *stmt);
 	int fillFile(sqlite3_stmt *stmt);
 	int fillFunction(sqlite3_stmt *stmt);
-	int fillInstruction(sqlite3_stmt *stmt);
+	static int fillInstruction(sqlite3_stmt *stmt,
+							   DBTable<INS_ID, instruction_t> *table);
 	int fillReference(sqlite3_stmt *stmt);
 	int fillSegment(sqlite3_stmt *stmt);
 	int fillThread(sqlite3_stmt *stmt);
 
+	int processStream(sqlite3 **db);
+	int processTail(sqlite3 **db);
+	int processMerge();
+	int processExternal();
+	int stepStream(sqlite3 **db, sqlite3_stmt *stmt);
+	template<typename Row>
+	int processStreamRow(const Row& row);	// see StmtRow, ShardReader::Row
+
 	int processInstruction(const instruction_t& instruction);
+	int processInstruction(const instruction_t& instruction,
+						   DBIndex<INS_ID, access_t>::Range accesses);
 	int processSegment(SEG_ID segmentId,
 					   const segment_t& segment,
 					   const instruction_t& instruction);
-	int processCall(const char* callId,
+	int processCall(CAL_ID callId,
 					const call_t& call,
 					const segment_t& segment,
 					const instruction_t& instruction);
+	int processCall(const call_t& call,
+					const function_t& function,
+					const file_t& file);
 	int processAccessGeneric(ACC_ID accessId,
 							 const access_t& access,
 							 const instruction_t& instruction,
@@ -1,15 +1,16 @@
 
 #include "Interpreter.h"
+#include <tuple>
 #include <boost/log/trivial.hpp>
 
-template<typename IdT, typename T>
-DBTable<IdT, T>::DBTable() {}
+template<typename IdT, typename T, bool Dense>
+DBTable<IdT, T, Dense>::DBTable() {}
 
-template<typename IdT, typename T>
-DBTable<IdT, T>::~DBTable() { }
+template<typename IdT, typename T, bool Dense>
+DBTable<IdT, T, Dense>::~DBTable() { }
 
-template<typename IdT, typename T>
-int DBTable<IdT, T>::fill(const IdT& id, const T& entry) {
+template<typename IdT, typename T, bool Dense>
+int DBTable<IdT, T, Dense>::fill(const IdT& id, const T& entry) {
 
 	//map_[id] = entry;
 	if ( map_.find( id ) != map_.end() )
@@ -19,8 +20,30 @@ int DBTable<IdT, T>::fill(const IdT& id, const T& entry) {
 	return IN_OK;
 }
 
-template<typename IdT, typename T>
-int DBTable<IdT, T>::get(const IdT& id, T** entry) {
+template<typename IdT, typename T, bool Dense>
+template<typename... Args>
+int DBTable<IdT, T, Dense>::emplace(const IdT& id, Args&&... args) {
+
+	if ( map_.find( id ) != map_.end() )
+		return IN_ENTRY_EXISTS;
+
+	map_.emplace( std::piecewise_construct, std::forward_as_tuple(id),
+				  std::forward_as_tuple(std::forward<Args>(args)...) );
+	return IN_OK;
+}
+
+template<typename IdT, typename T, bool Dense>
+int DBTable<IdT, T, Dense>::absorb(DBTable& other) {
+
+	for (auto& row : other.map_)
+		emplace(row.first, std::move(row.second));
+	strings_.absorb(other.strings_);
+	other.map_.clear();
+	return IN_OK;
+}
+
+template<typename IdT, typename T, bool Dense>
+int DBTable<IdT, T, Dense>::get(const IdT& id, T** entry) {
 
 	auto search = map_.find(id);
 	if (search != map_.end()) {
@@ -34,37 +57,132 @@ int DBTable<IdT, T>::get(const IdT& id, T** entry) {
 	}
 }
 
-template<typename IdT, typename T>
-unsigned DBTable<IdT, T>::size() const {
+template<typename IdT, typename T, bool Dense>
+unsigned DBTable<IdT, T, Dense>::size() const {
 	return map_.size();
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::iterator DBTable<IdT, T>::find(const IdT& id) {
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::iterator DBTable<IdT, T, Dense>::find(const IdT& id) {
 	return map_.find(id);
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::const_iterator DBTable<IdT, T>::find(const IdT& id) const {
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::const_iterator DBTable<IdT, T, Dense>::find(const IdT& id) const {
 	return map_.find(id);
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::iterator DBTable<IdT, T>::begin() {
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::iterator DBTable<IdT, T, Dense>::begin() {
 	return map_.begin(); 
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::const_iterator DBTable<IdT, T>::begin() const {
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::const_iterator DBTable<IdT, T, Dense>::begin() const {
 	return map_.begin(); 
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::iterator DBTable<IdT, T>::end() { 
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::iterator DBTable<IdT, T, Dense>::end() { 
 	return map_.end(); 
 }
 
-template<typename IdT, typename T>
-typename DBTable<IdT, T>::const_iterator DBTable<IdT, T>::end() const { 
+template<typename IdT, typename T, bool Dense>
+typename DBTable<IdT, T, Dense>::const_iterator DBTable<IdT, T, Dense>::end() const { 
 	return map_.end(); 
 }
+
+/******************************************************************************
+ * DBTable (dense)
+ *****************************************************************************/
+template<typename IdT, typename T>
+DBTable<IdT, T, true>::DBTable() {}
+
+template<typename IdT, typename T>
+DBTable<IdT, T, true>::~DBTable() { }
+
+template<typename IdT, typename T>
+bool DBTable<IdT, T, true>::contains(const IdT& id) const {
+	return ( static_cast<typename Index::size_type>(id) < index_.size() &&
+			 index_[id] != nullptr );
+}
+
+template<typename IdT, typename T>
+int DBTable<IdT, T, true>::fill(const IdT& id, const T& entry) {
+	return emplace(id, entry);
+}
+
+template<typename IdT, typename T>
+template<typename... Args>
+int DBTable<IdT, T, true>::emplace(const IdT& id, Args&&... args) {
+
+	if ( contains( id ) )
+		return IN_ENTRY_EXISTS;
+
+	if ( static_cast<typename Index::size_type>(id) >= index_.size() )
+		index_.resize(id + 1, nullptr);
+
+	index_[id] = rows_.emplace( std::piecewise_construct,
+								std::forward_as_tuple(id),
+								std::forward_as_tuple(std::forward<Args>(args)...) );
+	return IN_OK;
+}
+
+template<typename IdT, typename T>
+int DBTable<IdT, T, true>::absorb(DBTable& other) {
+
+	for (auto row : other.index_)
+		if (row != nullptr)
+			emplace(row->first, std::move(row->second));
+	strings_.absorb(other.strings_);
+	return IN_OK;
+}
+
+template<typename IdT, typename T>
+int DBTable<IdT, T, true>::get(const IdT& id, T** entry) {
+
+	if ( contains( id ) ) {
+		*entry = &index_[id]->second;
+		return IN_OK;
+	} else {
+		BOOST_LOG_TRIVIAL(error) << typeid(T).name()
+								 << " not found: " << id;
+		*entry = nullptr;
+		return IN_NO_ENTRY;
+	}
+}
+
+template<typename IdT, typename T>
+unsigned DBTable<IdT, T, true>::size() const {
+	return rows_.size();
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::iterator DBTable<IdT, T, true>::find(const IdT& id) {
+	return contains(id) ? iterator(&index_, id) : end();
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::const_iterator DBTable<IdT, T, true>::find(const IdT& id) const {
+	return contains(id) ? const_iterator(&index_, id) : end();
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::iterator DBTable<IdT, T, true>::begin() {
+	return iterator(&index_, 0);
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::const_iterator DBTable<IdT, T, true>::begin() const {
+	return const_iterator(&index_, 0);
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::iterator DBTable<IdT, T, true>::end() { 
+	return iterator(&index_, index_.size());
+}
+
+template<typename IdT, typename T>
+typename DBTable<IdT, T, true>::const_iterator DBTable<IdT, T, true>::end() const { 
+	return const_iterator(&index_, index_.size());
+}
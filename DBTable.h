@@ -9,8 +9,17 @@
 #define DBTABLE_H_
 
 #include <map>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include "StringArena.h"
+#include "RowArena.h"
 
-template<typename IdT, typename T>
+/******************************************************************************
+ * DBTable (ordered map, used for non-integral keys)
+ *****************************************************************************/
+template<typename IdT, typename T, bool Dense = std::is_integral<IdT>::value>
 class DBTable
 {
 public:
@@ -23,6 +32,8 @@ public:
 
 	int get(const IdT& id, T** entry);
 	int fill(const IdT& id, const T& entry);
+	template<typename... Args> int emplace(const IdT& id, Args&&... args);
+	int absorb(DBTable& other);	// move the rows of other into this table
 	
 	iterator find(const IdT& id);
 	const_iterator find(const IdT& id) const;
@@ -33,14 +44,92 @@ public:
 	iterator		end();
 	const_iterator	end() const;
 
+	StringArena& strings() { return strings_; }
+
 private:								  	
 	Map map_;
+	StringArena strings_;
 	
 	// prevent generated functions
 	DBTable(const DBTable&);
 	DBTable& operator=(const DBTable&);		 
 };
 
+/******************************************************************************
+ * DBTable (dense, used for integral keys)
+ *
+ * SQLite integer primary keys are dense, so the rows are constructed in
+ * place in a RowArena and an index vector maps every id directly to its row
+ * (nullptr = no row). Iteration visits the rows in ascending id order, just
+ * like the map variant. Tables keyed by anything but their own primary key
+ * must choose the map variant (Dense = false); the index grows to the
+ * largest id.
+ *****************************************************************************/
+template<typename IdT, typename T>
+class DBTable<IdT, T, true>
+{
+public:
+	typedef std::pair<IdT, T> value_type;
+	typedef RowArena<value_type> Rows;
+	typedef std::vector<value_type*> Index;
+
+	template<typename RowT>
+	class Iterator : public std::iterator<std::forward_iterator_tag, RowT> {
+	public:
+		Iterator(const Index *index, typename Index::size_type pos)
+			: index_(index), pos_(pos) { skip(); }
+
+		RowT& operator*() const { return *(*index_)[pos_]; }
+		RowT* operator->() const { return &**this; }
+		Iterator& operator++() { ++pos_; skip(); return *this; }
+		Iterator operator++(int) { Iterator tmp(*this); ++*this; return tmp; }
+		bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+		bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+	private:
+		const Index *index_;
+		typename Index::size_type pos_;
+
+		void skip() {
+			while (pos_ < index_->size() && (*index_)[pos_] == nullptr)
+				++pos_;
+		}
+	};
+
+	typedef Iterator<value_type> iterator;
+	typedef Iterator<const value_type> const_iterator;
+
+	DBTable();
+	~DBTable();
+
+	int get(const IdT& id, T** entry);
+	int fill(const IdT& id, const T& entry);
+	template<typename... Args> int emplace(const IdT& id, Args&&... args);
+	int absorb(DBTable& other);	// move the rows of other into this table
+	
+	iterator find(const IdT& id);
+	const_iterator find(const IdT& id) const;
+	unsigned size() const;
+
+	iterator		begin();
+	const_iterator	begin() const;
+	iterator		end();
+	const_iterator	end() const;
+
+	StringArena& strings() { return strings_; }
+
+private:
+	Rows rows_;
+	Index index_;
+	StringArena strings_;
+
+	bool contains(const IdT& id) const;
+
+	// prevent generated functions
+	DBTable(const DBTable&);
+	DBTable& operator=(const DBTable&);
+};
+
 #include "DBTable-inl.h"
 
-#endif /* DBTABLE_H_ */
\ No newline at end of file
+#endif /* DBTABLE_H_ */
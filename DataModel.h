@@ -9,14 +9,28 @@
 #define DATAMODEL_H_
 
 #include <string>
+#include <cstdint>
 
 /*----------------------------------------------------------------------------
  * Types
+ *
+ * Ids of the rows of the large trace tables (instructions, accesses,
+ * segments, references) and logical clocks grow with the trace length.
+ * They are 64 bit if built with SAAP_WIDE_IDS and 32 bit otherwise, to
+ * keep the hot structures compact. Thread, lock, call, function and file
+ * ids stay 32 bit either way.
  ----------------------------------------------------------------------------*/
-typedef int MemAddress;
+#ifdef SAAP_WIDE_IDS
+typedef uint64_t TraceId;
+typedef uint64_t Clock;
+#else
+typedef uint32_t TraceId;
+typedef uint32_t Clock;
+#endif
+
+typedef uint64_t MemAddress;
 typedef unsigned ThreadId;
-typedef unsigned int RefId;
-typedef std::string RefNo;
+typedef TraceId RefId;
 
 /*----------------------------------------------------------------------------
  * Instruction
@@ -1,4 +1,62 @@
 #include "Event.h"
+#include "ShadowThread.h"
+#include "ShadowLock.h"
+#include "ShadowVar.h"
+
+static EventRecord record(Events type, const ShadowThread *thread) {
+
+	EventRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type = type;
+	record.thread = thread->threadId;
+	return record;
+}
+
+EventRecord EventRecord::of(const NewThreadEvent *event) {
+
+	EventRecord rec = record(NEWTHREAD, event->getThread());
+	rec.childThread = event->getNewThreadInfo()->childThread->threadId;
+	return rec;
+}
+
+EventRecord EventRecord::of(const JoinEvent *event) {
+
+	EventRecord rec = record(JOIN, event->getThread());
+	rec.childThread = event->getJoinInfo()->childThread->threadId;
+	return rec;
+}
+
+EventRecord EventRecord::of(const AcquireEvent *event) {
+
+	EventRecord rec = record(ACQUIRE, event->getThread());
+	rec.lock = event->getAcquireInfo()->lock->lockId;
+	return rec;
+}
+
+EventRecord EventRecord::of(const ReleaseEvent *event) {
+
+	EventRecord rec = record(RELEASE, event->getThread());
+	rec.lock = event->getReleaseInfo()->lock->lockId;
+	return rec;
+}
+
+EventRecord EventRecord::of(const AccessEvent *event) {
+
+	const AccessInfo *info = event->getAccessInfo();
+	EventRecord rec = record(ACCESS, event->getThread());
+	rec.accessType = info->type;
+	rec.varType = info->var->type;
+	rec.instruction = info->instructionID;
+	rec.var = info->var->id;
+	return rec;
+}
+
+EventRecord EventRecord::of(const CallEvent *event, uint32_t call) {
+
+	EventRecord rec = record(CALL, event->getThread());
+	rec.call = call;
+	return rec;
+}
 
 //template<typename Key, typename Value>
 //const Value& Decoration<Key, Value>::get(const Key& key) const {
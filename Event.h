@@ -2,6 +2,8 @@
 #define EVENT_H_
 
 #include <cstring>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include "DataModel.h"
 
@@ -169,11 +171,11 @@ private:
  * Access Event
  *****************************************************************************/
 struct AccessInfo {
-	AccessInfo(Access::type Type, ShadowVar *Var, unsigned instructionID)
+	AccessInfo(Access::type Type, ShadowVar *Var, TraceId instructionID)
 		: type(Type), instructionID(instructionID), var(Var) {}
 
 	Access::type type;
-	unsigned instructionID;
+	TraceId instructionID;
 	ShadowVar *var;
 };
 
@@ -229,4 +231,64 @@ private:
 	CallEvent& operator=(const CallEvent&);
 };
 
+/******************************************************************************
+ * Event Record
+ *
+ * Fixed-size, trivially copyable form of an event, for arrays and ring
+ * buffers of events that are dispatched with a switch on the type. The
+ * payload holds ids only (ShadowThread::threadId, ShadowLock::lockId and
+ * ShadowVar::id), so records can be copied, spilled and replayed apart
+ * from the shadow entities. Calls refer to the call table of their batch.
+ *****************************************************************************/
+typedef struct EventRecord {
+	uint8_t type;				// Events
+	uint8_t accessType;			// Access::type (ACCESS)
+	uint8_t varType;			// ShadowVar::VarType (ACCESS)
+	ThreadId thread;
+	TraceId instruction;		// (ACCESS)
+	union {
+		ThreadId childThread;	// NEWTHREAD, JOIN
+		unsigned lock;			// ACQUIRE, RELEASE
+		RefId var;				// ACCESS
+		uint32_t call;			// CALL: index into the call table
+	};
+
+	static EventRecord of(const NewThreadEvent *event);
+	static EventRecord of(const JoinEvent *event);
+	static EventRecord of(const AcquireEvent *event);
+	static EventRecord of(const ReleaseEvent *event);
+	static EventRecord of(const AccessEvent *event);
+	static EventRecord of(const CallEvent *event, uint32_t call);
+} EventRecord;
+
+static_assert(sizeof(EventRecord) <= 24, "event records must stay compact");
+
+/******************************************************************************
+ * Event Batch
+ *
+ * Event records handed to a tool in one call (see Tool::onBatch), in
+ * publish order, with the call infos their call records refer to. Both
+ * are only valid during that call.
+ *****************************************************************************/
+class EventBatch {
+public:
+	typedef const EventRecord* const_iterator;
+
+	EventBatch(const EventRecord* records, size_t size, const CallInfo* calls)
+		: _records(records), _size(size), _calls(calls) {}
+
+	const_iterator begin() const { return _records; }
+	const_iterator end() const { return _records + _size; }
+	size_t size() const { return _size; }
+	const EventRecord& operator[](size_t pos) const { return _records[pos]; }
+	const CallInfo& call(const EventRecord& record) const {
+		return _calls[record.call];
+	}
+
+private:
+	const EventRecord* _records;
+	size_t _size;
+	const CallInfo* _calls;
+};
+
 #endif /* EVENT_H_ */
@@ -6,76 +6,102 @@
  */
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include "EventService.h"
 #include "Filter.h"
 #include "Tool.h"
 #include "Event.h"
+#include "ShadowVar.h"
 
-bool EventService::publish(NewThreadEvent *event) {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && NEWTHREAD ) {
-			it->first->create(event);
-		}
+EventService::AsyncProfile EventService::AsyncProfile::defaults() {
+
+	AsyncProfile profile = { 1 << 16, 64, 50 };
+	return profile;
+}
+
+EventService::~EventService() {
+
+	stopAsync();
+}
+
+bool EventService::publish(NewThreadEvent *event, const Filter::Scope *scope) {
+	for (const auto& subscriber : _subscribers[NEWTHREAD_SUBS]) {
+		if (accepts(subscriber.filter, scope))
+			subscriber.tool->create(event);
 	}
 
-	return true;
+	if ((_batchedEvents & NEWTHREAD) == 0)
+		return true;
+	return enqueue(EventRecord::of(event), scope);
 }
 
-bool EventService::publish(JoinEvent *event) {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && NEWTHREAD ) {
-			it->first->create(event);
-		}
+bool EventService::publish(JoinEvent *event, const Filter::Scope *scope) {
+	for (const auto& subscriber : _subscribers[JOIN_SUBS]) {
+		if (accepts(subscriber.filter, scope))
+			subscriber.tool->join(event);
 	}
 
-	return true;
+	if ((_batchedEvents & JOIN) == 0)
+		return true;
+	return enqueue(EventRecord::of(event), scope);
 }
 
-bool EventService::publish(AcquireEvent *event) {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && ACQUIRE ) {
-			it->first->acquire(event);
-		}
+bool EventService::publish(AcquireEvent *event, const Filter::Scope *scope) {
+	for (const auto& subscriber : _subscribers[ACQUIRE_SUBS]) {
+		if (accepts(subscriber.filter, scope))
+			subscriber.tool->acquire(event);
 	}
 
-	return true;
+	if ((_batchedEvents & ACQUIRE) == 0)
+		return true;
+	return enqueue(EventRecord::of(event), scope);
 }
 
-bool EventService::publish(ReleaseEvent *event) {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && RELEASE ) {
-			it->first->release(event);
-		}
+bool EventService::publish(ReleaseEvent *event, const Filter::Scope *scope) {
+	for (const auto& subscriber : _subscribers[RELEASE_SUBS]) {
+		if (accepts(subscriber.filter, scope))
+			subscriber.tool->release(event);
 	}
 
-	return true;
+	if ((_batchedEvents & RELEASE) == 0)
+		return true;
+	return enqueue(EventRecord::of(event), scope);
 }
 
-bool EventService::publish(AccessEvent *event) {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && ACCESS ) {
-			it->first->access(event);
+bool EventService::publish(AccessEvent *event, const Filter::Scope *scope) {
+	for (const auto& subscriber : _subscribers[ACCESS_SUBS]) {
+		if (accepts(subscriber.filter, scope) &&
+			(subscriber.filter == nullptr ||
+			 subscriber.filter->acceptsMemoryType(
+					event->getAccessInfo()->var->type))) {
+			subscriber.tool->access(event);
 		}
 	}
 
-	return true;
+	if ((_batchedEvents & ACCESS) == 0)
+		return true;
+	return enqueue(EventRecord::of(event), scope);
 }
 
-bool EventService::publish(CallEvent *event)
+bool EventService::publish(CallEvent *event, const Filter::Scope *scope)
 {
-	_observers_t::iterator it;
-	for (it = _observers.begin(); it != _observers.end(); ++it) {
-		if (it->second.events && CALL ) {
-			it->first->call(event);
-		}
+	for (const auto& subscriber : _subscribers[CALL_SUBS]) {
+		if (accepts(subscriber.filter, scope))
+			subscriber.tool->call(event);
 	}
 
-	return true;
+	if ((_batchedEvents & CALL) == 0)
+		return true;
+	// the text may only live as long as the current row
+	const CallInfo *info = event->getCallInfo();
+	uint32_t call = _buffer.callInfos.size();
+	_buffer.callInfos.emplace_back(info->runtime,
+								   _buffer.strings->store(info->fnSignature),
+								   info->fnType,
+								   _buffer.strings->store(info->fileName),
+								   _buffer.strings->store(info->filePath));
+	return enqueue(EventRecord::of(event, call), scope);
 }
 
 bool EventService::subscribe(Tool* tool,
@@ -85,15 +111,362 @@ bool EventService::subscribe(Tool* tool,
 	if (_observers.find(tool) != _observers.end())
 		return false;
 
+	flush();	// the tool only receives later events
+	if (_async)
+		stopWorkers();
 	struct _observers obj;
 	obj.filter = filter;
 	obj.events = events;
+	obj.order = _subscriptions++;
 	_observers[tool] = obj;
+	buildSubscribers();
+	if (_async)
+		startWorkers();
 
 	return true;
 }
 
 bool EventService::unsubscribe(Tool* tool) {
 
-	return (_observers.erase(tool) > 0);
+	flush();	// the tool still receives what it subscribed to
+	if (_observers.find(tool) == _observers.end())
+		return false;
+	if (_async)
+		stopWorkers();
+	_observers.erase(tool);
+	buildSubscribers();
+	if (_async)
+		startWorkers();
+	return true;
+}
+
+void EventService::buildSubscribers() {
+
+	static const Events events[N_SUBS] = { NEWTHREAD, JOIN, ACQUIRE, RELEASE,
+										   ACCESS, CALL };
+
+	for (auto& subscribers : _subscribers)
+		subscribers.clear();
+	_batched.clear();
+	_batchedEvents = 0;
+
+	for (auto tool : getTools()) {
+		const struct _observers& observer = _observers[tool];
+		struct _subscriber subscriber = { tool, observer.filter, observer.events };
+		if (_batchSize > 0 && tool->batched()) {
+			_batched.push_back(subscriber);
+			_batchedEvents |= observer.events;
+			continue;
+		}
+		for (unsigned i = 0; i < N_SUBS; ++i) {
+			if (observer.events & events[i])
+				_subscribers[i].push_back(subscriber);
+		}
+	}
+}
+
+void EventService::setBatchSize(size_t size) {
+
+	flush();
+	if (_async)
+		stopWorkers();
+	_batchSize = size;
+	_buffer.records.reserve(size);
+	_buffer.scopes.reserve(size);
+	_buffer.scoped.reserve(size);
+	_delivered.reserve(size);
+	_buffer.strings.reset(new StringArena());
+	buildSubscribers();
+	if (_async)
+		startWorkers();
+}
+
+bool EventService::enqueue(const EventRecord& record, const Filter::Scope *scope) {
+
+	_buffer.records.push_back(record);
+	_buffer.scopes.push_back(scope != nullptr ? *scope : Filter::Scope());
+	_buffer.scoped.push_back(scope != nullptr);
+	if (_buffer.records.size() >= _batchSize)
+		dispatch(false);	// async tools keep running behind the interpreter
+	return true;
+}
+
+void EventService::flush() {
+
+	dispatch(true);
+}
+
+void EventService::dispatch(bool drain) {
+
+	if (!_buffer.records.empty()) {
+		for (size_t i = 0; i < _batched.size(); ++i) {
+			select(_batched[i]);
+			if (_delivered.empty())
+				continue;
+			if (_async)
+				push(_workers[i].get());
+			else
+				_batched[i].tool->onBatch(EventBatch(_delivered.data(),
+												 _delivered.size(),
+												 _buffer.callInfos.data()));
+		}
+		if (_async)
+			retire();
+		else
+			clearBatch();
+	}
+
+	if (_async && drain)
+		this->drain();
+}
+
+// every tool gets the events it would have received one by one, in order
+void EventService::select(const struct _subscriber& subscriber) {
+
+	_delivered.clear();
+	for (size_t i = 0; i < _buffer.records.size(); ++i) {
+		const EventRecord& record = _buffer.records[i];
+		if ((subscriber.events & record.type) == 0 ||
+			!accepts(subscriber.filter,
+					 _buffer.scoped[i] ? &_buffer.scopes[i] : nullptr))
+			continue;
+		if (record.type == ACCESS && subscriber.filter != nullptr &&
+			!subscriber.filter->acceptsMemoryType(
+					static_cast<ShadowVar::VarType>(record.varType)))
+			continue;
+		_delivered.push_back(record);
+	}
+}
+
+void EventService::startAsync(const AsyncProfile& profile) {
+
+	stopAsync();
+	if (_batchSize == 0)
+		setBatchSize(4096);
+	_asyncProfile = profile;
+	_async = true;
+	startWorkers();
+}
+
+void EventService::stopAsync() {
+
+	if (!_async)
+		return;
+
+	flush();
+	stopWorkers();
+	_async = false;
+}
+
+void EventService::startWorkers() {
+
+	for (const auto& subscriber : _batched) {
+		std::unique_ptr<struct _worker> worker(new struct _worker);
+		worker->tool = subscriber.tool;
+		worker->ring.reset(new SpscRing<EventRecord>(_asyncProfile.capacity));
+		worker->calls.reset(new SpscRing<struct _call>(_asyncProfile.capacity));
+		worker->chunk = _batchSize;
+		worker->pushed = 0;
+		worker->consumed = 0;
+		worker->stop = false;
+		worker->thread = std::thread(&EventService::consume, this, worker.get());
+		_workers.push_back(std::move(worker));
+	}
+}
+
+void EventService::stopWorkers() {
+
+	for (auto& worker : _workers)
+		worker->stop.store(true, std::memory_order_release);
+	for (auto& worker : _workers)
+		worker->thread.join();
+	_workers.clear();
+	_retired.clear();
+}
+
+// The call info of a call record goes ahead of the record, so the worker
+// finds it as soon as it got the record.
+void EventService::push(struct _worker *worker) {
+
+	size_t begin = 0;
+	for (size_t i = 0; i < _delivered.size(); ++i) {
+		if (_delivered[i].type != CALL)
+			continue;
+		const CallInfo& info = _buffer.callInfos[_delivered[i].call];
+		struct _call call = { info.runtime, info.fnSignature, info.fnType,
+							  info.fileName, info.filePath };
+		pushAll(worker->ring.get(), _delivered.data() + begin, i - begin);
+		pushAll(worker->calls.get(), &call, 1);
+		begin = i;
+	}
+	pushAll(worker->ring.get(), _delivered.data() + begin,
+			_delivered.size() - begin);
+	worker->pushed += _delivered.size();
+}
+
+// waits as long as the ring is full (backpressure)
+template<typename T>
+void EventService::pushAll(SpscRing<T> *ring, const T *items, size_t count) {
+
+	unsigned attempt = 0;
+	size_t done = 0;
+	while (done < count) {
+		size_t pushed = ring->push(items + done, count - done);
+		if (pushed == 0) {
+			backoff(&attempt, _asyncProfile);
+			continue;
+		}
+		attempt = 0;
+		done += pushed;
+	}
+}
+
+// runs on the worker thread until stopped and drained
+void EventService::consume(struct _worker *worker) {
+
+	std::vector<EventRecord> chunk(worker->chunk);
+	std::vector<CallInfo> calls;	// the call table of the chunk
+	unsigned attempt = 0;
+	for (;;) {
+		size_t count = worker->ring->pop(chunk.data(), chunk.size());
+		if (count == 0) {
+			if (worker->stop.load(std::memory_order_acquire) &&
+				worker->ring->empty())
+				return;
+			backoff(&attempt, _asyncProfile);
+			continue;
+		}
+		attempt = 0;
+
+		calls.clear();
+		for (size_t i = 0; i < count; ++i) {
+			if (chunk[i].type != CALL)
+				continue;
+			struct _call call;
+			while (worker->calls->pop(&call, 1) == 0)
+				std::this_thread::yield();
+			chunk[i].call = calls.size();
+			calls.emplace_back(call.runtime, call.fnSignature, call.fnType,
+							   call.fileName, call.filePath);
+		}
+		worker->tool->onBatch(EventBatch(chunk.data(), count, calls.data()));
+		worker->consumed.fetch_add(count, std::memory_order_release);
+	}
+}
+
+// keeps the call info text of the pushed batch until it is consumed
+void EventService::retire() {
+
+	while (!_retired.empty() && consumed(_retired.front()))
+		_retired.pop_front();
+
+	if (!_buffer.callInfos.empty()) {
+		struct _retired batch;
+		for (const auto& worker : _workers)
+			batch.marks.push_back(worker->pushed);
+		batch.strings = std::move(_buffer.strings);
+		_retired.push_back(std::move(batch));
+	}
+	clearBatch();
+}
+
+bool EventService::consumed(const struct _retired& batch) const {
+
+	for (size_t i = 0; i < _workers.size(); ++i)
+		if (_workers[i]->consumed.load(std::memory_order_acquire) < batch.marks[i])
+			return false;
+	return true;
+}
+
+void EventService::drain() {
+
+	for (auto& worker : _workers) {
+		unsigned attempt = 0;
+		while (worker->consumed.load(std::memory_order_acquire) < worker->pushed)
+			backoff(&attempt, _asyncProfile);
+	}
+	_retired.clear();
+}
+
+void EventService::backoff(unsigned *attempt, const AsyncProfile& profile) {
+
+	if (++*attempt <= profile.spins)
+		std::this_thread::yield();
+	else
+		std::this_thread::sleep_for(
+			std::chrono::microseconds(profile.sleepMicros));
+}
+
+void EventService::clearBatch() {
+
+	_buffer.records.clear();
+	_buffer.scopes.clear();
+	_buffer.scoped.clear();
+	_buffer.callInfos.clear();
+	_buffer.strings.reset(new StringArena());
+}
+
+int EventService::subscribedEvents() const {
+
+	int events = 0;
+	for (const auto& observer : _observers)
+		events |= observer.second.events;
+	return events;
+}
+
+bool EventService::accepts(const Filter* filter, const Filter::Scope *scope) {
+
+	return filter == nullptr || scope == nullptr || filter->accepts(*scope);
+}
+
+void EventService::getCommonFilter(Filter *common) const {
+
+	if (_observers.empty())
+		return;
+
+	// an id set is common only if every subscriber restricts it
+	int excluded = ~0;
+	bool threads = true, functions = true, files = true;
+	for (const auto& observer : _observers) {
+		const Filter *filter = observer.second.filter;
+		if (filter == nullptr)
+			return;
+		excluded &= filter->getExcludedMemoryTypes();
+		threads &= !filter->getThreads().empty();
+		functions &= !filter->getFunctions().empty();
+		files &= !filter->getFiles().empty();
+	}
+
+	common->excludeMemoryTypes(excluded);
+	for (const auto& observer : _observers) {
+		const Filter *filter = observer.second.filter;
+		if (threads)
+			for (auto id : filter->getThreads()) common->thread(id);
+		if (functions)
+			for (auto id : filter->getFunctions()) common->function(id);
+		if (files)
+			for (auto id : filter->getFiles()) common->file(id);
+	}
+}
+
+bool EventService::filtersFiles() const {
+
+	for (const auto& observer : _observers)
+		if (observer.second.filter != nullptr &&
+			!observer.second.filter->getFiles().empty())
+			return true;
+	return false;
+}
+
+std::vector<Tool*> EventService::getTools() const {
+
+	std::vector<std::pair<unsigned, Tool*> > ordered;
+	for (const auto& observer : _observers)
+		ordered.push_back(std::make_pair(observer.second.order, observer.first));
+	std::sort(ordered.begin(), ordered.end());
+
+	std::vector<Tool*> tools;
+	for (const auto& entry : ordered)
+		tools.push_back(entry.second);
+	return tools;
 }
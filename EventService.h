@@ -8,38 +8,166 @@
 #ifndef EVENTSERVICE_H_
 #define EVENTSERVICE_H_
 
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "Event.h"
 #include "Tool.h"
 #include "Filter.h"
+#include "StringArena.h"
+#include "SpscRing.h"
 
 /******************************************************************************
  * EventService (Observable)
+ *
+ * Subscriptions are kept per tool; on every (un)subscription they are
+ * flattened into one array per event type, so publishing an event only
+ * visits the tools that asked for it.
+ *
+ * With a batch size, events for tools that take batches (Tool::batched)
+ * are recorded (see EventRecord) into a buffer instead and every such tool
+ * receives the events it subscribed to through a single Tool::onBatch call
+ * once the buffer is full or flushed. Other tools keep receiving their
+ * events one by one as they are published.
+ *
+ * In async mode every batched tool runs on a thread of its own. Flushing
+ * hands each tool its records through a bounded single-producer/single-
+ * consumer ring, so the tools run concurrently with each other and with
+ * the interpreter. A full ring makes the interpreter wait (backpressure, see
+ * AsyncProfile); flush() returns once every tool has consumed everything.
  *****************************************************************************/
 class EventService {
 public:
-	EventService() {}
-	bool publish(NewThreadEvent *event);
-	bool publish(JoinEvent *event);
-	bool publish(AcquireEvent *event);
-	bool publish(ReleaseEvent *event);
-	bool publish(AccessEvent *event);
-	bool publish(CallEvent *event);
+	typedef struct AsyncProfile {
+		size_t capacity;		// records per tool ring
+		unsigned spins;			// yields before sleeping on a full/empty ring
+		unsigned sleepMicros;	// sleep between later attempts
+
+		static AsyncProfile defaults();
+	} AsyncProfile;
+
+	EventService() : _subscriptions(0), _batchedEvents(0), _batchSize(0),
+					 _async(false),
+					 _asyncProfile(AsyncProfile::defaults()) {}
+	virtual ~EventService();
+	// scope: the call the event was raised in, checked against the filters
+	// (see StaticEventService for tool sets fixed at compile time)
+	virtual bool publish(NewThreadEvent *event, const Filter::Scope *scope = nullptr);
+	virtual bool publish(JoinEvent *event, const Filter::Scope *scope = nullptr);
+	virtual bool publish(AcquireEvent *event, const Filter::Scope *scope = nullptr);
+	virtual bool publish(ReleaseEvent *event, const Filter::Scope *scope = nullptr);
+	virtual bool publish(AccessEvent *event, const Filter::Scope *scope = nullptr);
+	virtual bool publish(CallEvent *event, const Filter::Scope *scope = nullptr);
 	bool subscribe(Tool* tool, const Filter* filter, enum Events events);
 	bool unsubscribe(Tool* tool);
 
+	// buffer up to size events per delivery (0: deliver immediately)
+	void setBatchSize(size_t size);
+	void flush();	// deliver the buffered events
+
+	// run every tool on its own thread (batches of 4096 unless set)
+	void startAsync(const AsyncProfile& profile = AsyncProfile::defaults());
+	void stopAsync();
+
+	int subscribedEvents() const;	// union of all subscribed events
+
+	// predicates every subscriber agrees on (the weakest of all filters),
+	// so an interpreter may drop what no subscriber would accept
+	void getCommonFilter(Filter *common) const;
+	bool filtersFiles() const;	// does any subscriber restrict files?
+	std::vector<Tool*> getTools() const;	// in subscription order
+
 private:
 	// structures
 	struct _observers {
 		const Filter* filter;
 		enum Events events;
+		unsigned order;		// subscription sequence number
 	};
 
+	struct _subscriber {
+		Tool* tool;
+		const Filter* filter;
+		enum Events events;
+	};
+
+	// the buffered events, in publish order
+	struct _batch {
+		std::vector<EventRecord> records;
+		std::vector<Filter::Scope> scopes;
+		std::vector<bool> scoped;		// was a scope published?
+		std::vector<CallInfo> callInfos;	// the call table of the records
+		std::unique_ptr<StringArena> strings;	// text of the call infos
+	};
+
+	// a call info on its way to a worker
+	struct _call {
+		double runtime;
+		const char* fnSignature;
+		Function::type fnType;
+		const char* fileName;
+		const char* filePath;
+	};
+
+	// thread and rings of a tool in async mode
+	struct _worker {
+		Tool* tool;
+		std::unique_ptr<SpscRing<EventRecord> > ring;
+		std::unique_ptr<SpscRing<struct _call> > calls;	// of the call records
+		size_t chunk;							// records per onBatch call
+		unsigned long pushed;					// by the interpreter thread
+		std::atomic<unsigned long> consumed;	// by the worker thread
+		std::atomic<bool> stop;
+		std::thread thread;
+	};
+
+	// call info text of a pushed batch, kept until every worker is past it
+	struct _retired {
+		std::vector<unsigned long> marks;	// pushed count per worker
+		std::unique_ptr<StringArena> strings;
+	};
+
+	// one subscriber array per event type (see enum Events)
+	enum { NEWTHREAD_SUBS, JOIN_SUBS, ACQUIRE_SUBS, RELEASE_SUBS, ACCESS_SUBS,
+		   CALL_SUBS, N_SUBS };
+
 	// types
 	typedef std::map<Tool*, struct _observers> _observers_t;
+	typedef std::vector<struct _subscriber> _subscribers_t;
 
 	// private members
 	_observers_t _observers;
+	unsigned _subscriptions;
+	_subscribers_t _subscribers[N_SUBS];	// one by one, in subscription order
+	_subscribers_t _batched;				// by onBatch, in subscription order
+	int _batchedEvents;						// union of the _batched events
+	size_t _batchSize;
+	struct _batch _buffer;
+	std::vector<EventRecord> _delivered;	// events of one tool's batch
+	bool _async;
+	AsyncProfile _asyncProfile;
+	std::vector<std::unique_ptr<struct _worker> > _workers;	// as _batched
+	std::deque<struct _retired> _retired;
+
+	void buildSubscribers();
+	void dispatch(bool drain);
+	void select(const struct _subscriber& subscriber);
+	void startWorkers();
+	void stopWorkers();
+	void push(struct _worker *worker);
+	template<typename T>
+	void pushAll(SpscRing<T> *ring, const T *items, size_t count);
+	void consume(struct _worker *worker);
+	void retire();
+	bool consumed(const struct _retired& batch) const;
+	void drain();
+	static void backoff(unsigned *attempt, const AsyncProfile& profile);
+	bool enqueue(const EventRecord& record, const Filter::Scope *scope);
+	void clearBatch();
+	static bool accepts(const Filter* filter, const Filter::Scope *scope);
 
 	// prevent generated functions
 	EventService(const EventService&);
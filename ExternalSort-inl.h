@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "Interpreter.h"
+
+template<typename T, typename Less>
+ExternalSort<T, Less>::ExternalSort(std::size_t budget, const char *directory,
+									Less less)
+	: budget_(std::max<std::size_t>(budget / sizeof(T), 1)),
+	  directory_(directory), less_(less), pos_(0), bufferRows_(0),
+	  status_(IN_OK) {}
+
+template<typename T, typename Less>
+ExternalSort<T, Less>::~ExternalSort() {
+
+	for (auto& run : runs_)
+		fclose(run.file);
+}
+
+template<typename T, typename Less>
+int ExternalSort<T, Less>::add(const T& row) {
+
+	// grow up to the budget, but not past it
+	if (rows_.size() == rows_.capacity())
+		rows_.reserve(std::min(std::max<std::size_t>(2 * rows_.capacity(), 1024),
+							   budget_));
+
+	rows_.push_back(row);
+	return rows_.size() < budget_ ? IN_OK : spill();
+}
+
+template<typename T, typename Less>
+int ExternalSort<T, Less>::spill() {
+
+	std::sort(rows_.begin(), rows_.end(), less_);
+
+	// the file is unlinked right away and vanishes with its descriptor
+	std::string path = directory_ + "/saap-spill-XXXXXX";
+	int fd = mkstemp(&path[0]);
+	FILE *file = fd < 0 ? nullptr : fdopen(fd, "w+b");
+	if (file == nullptr) {
+		BOOST_LOG_TRIVIAL(error) << "Can't create spill file in " << directory_;
+		if (fd >= 0)
+			close(fd);
+		return IN_ABORT;
+	}
+	unlink(path.c_str());
+
+	Run run = { file, std::vector<T>(), 0 };
+	runs_.push_back(run);
+	if (fwrite(rows_.data(), sizeof(T), rows_.size(), file) != rows_.size()) {
+		BOOST_LOG_TRIVIAL(error) << "Can't write spill file in " << directory_;
+		return IN_ABORT;
+	}
+
+	BOOST_LOG_TRIVIAL(trace) << "Spilled run " << runs_.size() << " ("
+							 << rows_.size() << " rows)";
+	rows_.clear();
+	return IN_OK;
+}
+
+template<typename T, typename Less>
+int ExternalSort<T, Less>::finish() {
+
+	if (runs_.empty()) {
+		std::sort(rows_.begin(), rows_.end(), less_);
+		pos_ = 0;
+		return IN_OK;
+	}
+
+	if (!rows_.empty() && spill() != IN_OK)
+		return IN_ABORT;
+	std::vector<T>().swap(rows_);
+
+	// the budget is shared by the read buffers of all runs
+	bufferRows_ = std::max<std::size_t>(budget_ / runs_.size(), 1024);
+	for (unsigned i = 0; i < runs_.size(); ++i) {
+		rewind(runs_[i].file);
+		if (fillBuffer(runs_[i]))
+			heap_.push_back(i);
+	}
+	std::make_heap(heap_.begin(), heap_.end(),
+				   [this](unsigned lhs, unsigned rhs) { return heapLess(lhs, rhs); });
+	return status_;
+}
+
+template<typename T, typename Less>
+bool ExternalSort<T, Less>::next(T *row) {
+
+	if (runs_.empty()) {
+		if (pos_ >= rows_.size())
+			return false;
+		*row = rows_[pos_++];
+		return true;
+	}
+
+	if (heap_.empty() || status_ != IN_OK)
+		return false;
+
+	auto comp = [this](unsigned lhs, unsigned rhs) { return heapLess(lhs, rhs); };
+	std::pop_heap(heap_.begin(), heap_.end(), comp);
+	Run& run = runs_[heap_.back()];
+	*row = run.buffer[run.pos++];
+
+	if (run.pos < run.buffer.size() || fillBuffer(run))
+		std::push_heap(heap_.begin(), heap_.end(), comp);
+	else
+		heap_.pop_back();
+	return true;
+}
+
+template<typename T, typename Less>
+bool ExternalSort<T, Less>::fillBuffer(Run& run) {
+
+	run.buffer.resize(bufferRows_);
+	run.buffer.resize(fread(run.buffer.data(), sizeof(T), bufferRows_, run.file));
+	run.pos = 0;
+
+	// a short read is the end of the run unless the read failed
+	if (ferror(run.file)) {
+		BOOST_LOG_TRIVIAL(error) << "Can't read spill file in " << directory_;
+		status_ = IN_ABORT;
+		return false;
+	}
+	return !run.buffer.empty();
+}
+
+// Orders the heap by the current row of every run, earlier runs first on
+// ties; std::*_heap keep the greatest element on top, hence the swap.
+template<typename T, typename Less>
+bool ExternalSort<T, Less>::heapLess(unsigned lhs, unsigned rhs) const {
+
+	const T& left = runs_[lhs].buffer[runs_[lhs].pos];
+	const T& right = runs_[rhs].buffer[runs_[rhs].pos];
+	if (less_(right, left))
+		return true;
+	if (less_(left, right))
+		return false;
+	return rhs < lhs;
+}
@@ -0,0 +1,65 @@
+/*
+ * ExternalSort.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef EXTERNALSORT_H_
+#define EXTERNALSORT_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/******************************************************************************
+ * ExternalSort
+ *
+ * Sorts more rows of a trivially copyable type than fit into a memory
+ * budget. Rows are collected until the budget is used, then sorted and
+ * spilled as a run into an unlinked temporary file in the spill
+ * directory. finish() sorts the last run; next() then merges all runs
+ * with one read buffer per run. If everything fits, nothing is spilled.
+ *****************************************************************************/
+template<typename T, typename Less>
+class ExternalSort {
+public:
+	ExternalSort(std::size_t budget, const char *directory, Less less = Less());
+	~ExternalSort();
+
+	int add(const T& row);
+	int finish();
+	bool next(T *row);		// false after the last row or on read errors
+
+	unsigned runs() const { return runs_.size(); }
+	int status() const { return status_; }	// IN_ABORT after read errors
+
+private:
+	typedef struct Run {
+		FILE *file;
+		std::vector<T> buffer;
+		std::size_t pos;
+	} Run;
+
+	const std::size_t budget_;	// in rows
+	const std::string directory_;
+	Less less_;
+	std::vector<T> rows_;	// current run, or all rows if nothing was spilled
+	std::size_t pos_;		// next row of rows_ if nothing was spilled
+	std::vector<Run> runs_;
+	std::size_t bufferRows_;	// per run while merging
+	std::vector<unsigned> heap_;	// runs by their current row
+	int status_;
+
+	int spill();
+	bool fillBuffer(Run& run);
+	bool heapLess(unsigned lhs, unsigned rhs) const;
+
+	// prevent generated functions
+	ExternalSort(const ExternalSort&);
+	ExternalSort& operator=(const ExternalSort&);
+};
+
+#include "ExternalSort-inl.h"
+
+#endif /* EXTERNALSORT_H_ */
@@ -8,14 +8,55 @@
 #ifndef FILTER_H_
 #define FILTER_H_
 
+#include <set>
+
 /******************************************************************************
  * Filter
+ *
+ * Predicates a tool subscribes with. Memory types restrict access events;
+ * threads, functions and files restrict every event to instructions
+ * executed within a matching call. Empty id sets match everything.
  *****************************************************************************/
 class Filter {
 public:
-	Filter() {}
+	typedef std::set<unsigned> IdSet;
+
+	// the call an event was raised in
+	typedef struct Scope {
+		unsigned thread;	// thread id as recorded in the trace
+		unsigned function;
+		unsigned file;
+	} Scope;
+
+	Filter() : excludedMemoryTypes_(0) {}
+
+	// ShadowVar::VarType bits whose accesses are not published
+	Filter& excludeMemoryTypes(int types) { excludedMemoryTypes_ |= types; return *this; }
+	Filter& thread(unsigned id) { threads_.insert(id); return *this; }
+	Filter& function(unsigned id) { functions_.insert(id); return *this; }
+	Filter& file(unsigned id) { files_.insert(id); return *this; }
+
+	int getExcludedMemoryTypes() const { return excludedMemoryTypes_; }
+	const IdSet& getThreads() const { return threads_; }
+	const IdSet& getFunctions() const { return functions_; }
+	const IdSet& getFiles() const { return files_; }
+
+	bool acceptsMemoryType(int type) const {
+		return (excludedMemoryTypes_ & type) == 0;
+	}
+	bool accepts(const Scope& scope) const {
+		return matches(threads_, scope.thread) &&
+			   matches(functions_, scope.function) &&
+			   matches(files_, scope.file);
+	}
 
 private:
+	int excludedMemoryTypes_;
+	IdSet threads_, functions_, files_;
+
+	static bool matches(const IdSet& ids, unsigned id) {
+		return ids.empty() || ids.count(id) > 0;
+	}
 
 	// prevent generated functions
 	Filter(const Filter&);
@@ -1,4 +1,6 @@
 #include "Interpreter.h"
+#include "Event.h"
+#include "Checkpoint.h"
 
 #include <boost/log/core.hpp>
 #include <boost/log/utility/setup/file.hpp>
@@ -10,10 +12,42 @@ namespace logging = boost::log;
 namespace expr = boost::log::expressions;
 
 Interpreter::Interpreter(LockMgr* lockMgr, ThreadMgr* threadMgr, const char* logFile)
-	: lockMgr_(lockMgr), threadMgr_(threadMgr), logFile_(logFile) {
+	: lockMgr_(lockMgr), threadMgr_(threadMgr), report_(nullptr),
+	  logFile_(logFile), checkpoint_(nullptr), resume_(false), resumed_(false),
+	  resumeAfter_(0), instructions_(0) {
 	initLogger();
 }
 
+Interpreter::~Interpreter() {
+
+	delete checkpoint_;
+}
+
+void Interpreter::setCheckpoint(const char* path, unsigned interval, bool resume) {
+
+	delete checkpoint_;
+	checkpoint_ = new Checkpoint(path, interval, getEventService(),
+								 threadMgr_, lockMgr_);
+	resume_ = resume;
+}
+
+int Interpreter::restoreCheckpoint() {
+
+	if (checkpoint_ == nullptr || !resume_)
+		return IN_OK;
+
+	int rc = checkpoint_->restore(&resumeAfter_);
+	resumed_ = rc == IN_OK;
+	return rc == IN_ABORT ? IN_ABORT : IN_OK;
+}
+
+void Interpreter::instructionDone(INS_ID instruction) {
+
+	++instructions_;
+	if (checkpoint_ != nullptr)
+		checkpoint_->instructionDone(instruction);
+}
+
 void Interpreter::initLogger() {
 
 	logging::add_file_log(
@@ -33,3 +67,23 @@ void Interpreter::initLogger() {
 
 	logging::add_common_attributes();
 }
+
+int Interpreter::instructionEvents(Instruction::type type) {
+
+	switch (type) {
+	case Instruction::MEMACCESS:
+		return ACCESS;
+	case Instruction::CALL:
+		return CALL;
+	case Instruction::ACQUIRE:
+		return ACQUIRE;
+	case Instruction::RELEASE:
+		return RELEASE;
+	case Instruction::FORK:
+		return NEWTHREAD;
+	case Instruction::JOIN:
+		return JOIN;
+	default:
+		return 0;
+	}
+}
@@ -8,6 +8,9 @@
 #ifndef INTERPRETER_H_
 #define INTERPRETER_H_
 
+#include "DataModel.h"
+#include "DBDataModel.h"
+
 /******************************************************************************
  * Constants and Types
  *****************************************************************************/
@@ -21,6 +24,8 @@ typedef enum {
 class EventService;
 class LockMgr;
 class ThreadMgr;
+class Checkpoint;
+class RunReport;
 
 /******************************************************************************
  * Interpreter (abstract)
@@ -31,15 +36,45 @@ public:
 	virtual int process() = 0;
 	void initLogger();
 
-	virtual ~Interpreter() {};
+	virtual ~Interpreter();
 	virtual EventService* getEventService() = 0;
 
+	// save the state every interval instructions to path; with resume,
+	// continue after the instruction of the checkpoint found there
+	void setCheckpoint(const char* path, unsigned interval, bool resume);
+
+	// record table and phase statistics into report (see RunReport)
+	void setReport(RunReport* report) { report_ = report; }
+
 protected:
 	LockMgr* lockMgr_;
 	ThreadMgr* threadMgr_;
+	RunReport* report_;		// nullptr if not reporting
+
+	// checkpointing, for interpreters that process instructions in id order
+	int restoreCheckpoint();
+	bool isResumed(INS_ID instruction) const {
+		return resumed_ && instruction <= resumeAfter_;
+	}
+	bool isResuming() const { return resumed_; }
+	INS_ID getResumePoint() const { return resumeAfter_; }
+	void instructionDone(INS_ID instruction);
+	unsigned long instructionsDone() const { return instructions_; }
+
+	// events (see enum Events) published for an instruction type
+	static int instructionEvents(Instruction::type type);
 
 private:
 	const char* logFile_;
+	Checkpoint* checkpoint_;
+	bool resume_;
+	bool resumed_;
+	INS_ID resumeAfter_;
+	unsigned long instructions_;	// interpreted in this run
+
+	// prevent generated functions
+	Interpreter(const Interpreter&);
+	Interpreter& operator=(const Interpreter&);
 };
 
 
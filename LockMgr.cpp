@@ -1,8 +1,9 @@
 #include "LockMgr.h"
+#include "Checkpoint.h"
 
 ShadowLock::LockId LockMgr::currentLockId_ = 0;
 
-ShadowLock* LockMgr::getLock(RefNo refNo) {
+ShadowLock* LockMgr::getLock(RefId refId) {
 	
 	ShadowLock* lock = nullptr;
 	/*auto search = memLockMap_.find(address);
@@ -13,20 +14,55 @@ ShadowLock* LockMgr::getLock(RefNo refNo) {
 	}
 	return lock;*/
 
-	auto search = memLockMap_.find(refNo);
+	auto search = memLockMap_.find(refId);
 	if (search != memLockMap_.end()) {
 		lock = search->second;
 	} else {
 		lock = new ShadowLock(LockMgr::currentLockId_++);
-		memLockMap_.insert(std::make_pair(refNo, lock));
+		memLockMap_.insert(std::make_pair(refId, lock));
 	}
 	return lock;
 }
 
-void LockMgr::lockDestroyed(RefNo refNo) {
+void LockMgr::lockDestroyed(RefId refId) {
 	
-	auto search = memLockMap_.find(refNo);
+	auto search = memLockMap_.find(refId);
 	if (search != memLockMap_.end())
 		delete search->second;
-	memLockMap_.erase(refNo);
-}
\ No newline at end of file
+	memLockMap_.erase(refId);
+}
+
+void LockMgr::serialize(rapidjson::Value& state,
+						rapidjson::Document::AllocatorType& allocator) const {
+
+	rapidjson::Value mappings(rapidjson::kArrayType);
+	for (const auto& entry : memLockMap_) {
+		rapidjson::Value mapping(rapidjson::kArrayType);
+		mapping.PushBack(entry.first, allocator);
+		mapping.PushBack(entry.second->lockId, allocator);
+		mappings.PushBack(mapping, allocator);
+	}
+
+	state.SetObject();
+	state.AddMember("next", LockMgr::currentLockId_, allocator);
+	state.AddMember("mappings", mappings, allocator);
+}
+
+bool LockMgr::restore(const rapidjson::Value& state, ShadowIndex *index) {
+
+	if (!Checkpoint::hasArray(state, "mappings") || !state.HasMember("next") ||
+		!state["next"].IsUint())
+		return false;
+
+	const rapidjson::Value& mappings = state["mappings"];
+	for (rapidjson::SizeType i = 0; i < mappings.Size(); ++i) {
+		if (!Checkpoint::isTuple(mappings[i], 2) || !mappings[i][0u].IsUint64() ||
+			!mappings[i][1u].IsUint())
+			return false;
+		ShadowLock *shadow = new ShadowLock(mappings[i][1u].GetUint());
+		memLockMap_[mappings[i][0u].GetUint64()] = shadow;	// RefId
+		index->locks[shadow->lockId] = shadow;
+	}
+	LockMgr::currentLockId_ = state["next"].GetUint();
+	return true;
+}
@@ -10,6 +10,9 @@
 
 #include "DataModel.h"
 #include "ShadowLock.h"
+#include "rapidjson/document.h"
+
+struct ShadowIndex;
 
 /******************************************************************************
  * LockMgr
@@ -19,12 +22,17 @@ public:
 	LockMgr() {}
 	~LockMgr() {}
 
-	ShadowLock* getLock(RefNo refNo);
-	void lockDestroyed(RefNo refNo);
+	ShadowLock* getLock(RefId refId);
+	void lockDestroyed(RefId refId);
+
+	// checkpointing: lock mappings and the next shadow lock id
+	void serialize(rapidjson::Value& state,
+				   rapidjson::Document::AllocatorType& allocator) const;
+	bool restore(const rapidjson::Value& state, ShadowIndex *index);	// false if malformed
 
 private:
 	static ShadowLock::LockId currentLockId_;
-	typedef std::map<RefNo, ShadowLock*> MemLockMap_;
+	typedef std::map<RefId, ShadowLock*> MemLockMap_;
 	
 	MemLockMap_ memLockMap_;
 
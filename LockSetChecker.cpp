@@ -14,6 +14,7 @@
 #include "ShadowThread.h"
 #include "ShadowVar.h"
 #include "ShadowLock.h"
+#include "Checkpoint.h"
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
@@ -29,11 +30,9 @@ LockSetChecker::~LockSetChecker() {
 
 void LockSetChecker::create(const Event* e) {
 
-   	ShadowThread* childThread = 
-		dynamic_cast<const NewThreadEvent*>(e)->getNewThreadInfo()->childThread;
-
-	// LockSet_u = set of all possible locks
-	lockSet_[childThread] =  lockSet_[e->getThread()];
+	threadCreated(e->getThread()->threadId,
+				  static_cast<const NewThreadEvent*>(e)->getNewThreadInfo()
+					  ->childThread->threadId);
 }
 
 void LockSetChecker::join(const Event* e) {
@@ -42,34 +41,63 @@ void LockSetChecker::join(const Event* e) {
 
 void LockSetChecker::acquire(const Event* e) {
 
-	// LockSet_t = LockSet_t + {lock}	
-	lockSet_[e->getThread()].insert(((AcquireEvent*)e)->getAcquireInfo()->lock);
+	lockAcquired(e->getThread()->threadId,
+				 static_cast<const AcquireEvent*>(e)->getAcquireInfo()
+					 ->lock->lockId);
 }
 
 void LockSetChecker::release(const Event* e) {
 
-	// LockSet_t = LockSet_t - {lock}
-	auto lock = ((AcquireEvent*)e)->getAcquireInfo()->lock;
-	lockSet_[e->getThread()].erase(lock); 
+	lockReleased(e->getThread()->threadId,
+				 static_cast<const ReleaseEvent*>(e)->getReleaseInfo()
+					 ->lock->lockId);
 }
 
 void LockSetChecker::access(const Event* e) {
 
-	const AccessEvent *event = dynamic_cast<const AccessEvent*>(e);
-	const RefId ref = event->getAccessInfo()->var->id;
-	const ThreadId threadId = event->getThread()->threadId;
+	const AccessInfo *info = static_cast<const AccessEvent*>(e)->getAccessInfo();
+	varAccessed(e->getThread()->threadId, info->var->id, info->var->type,
+				info->type, info->instructionID);
+}
+
+void LockSetChecker::threadCreated(ThreadId threadId, ThreadId childId) {
+
+	// LockSet_u = set of all possible locks
+	lockSet_[childId] =  lockSet_[threadId];
+}
+
+void LockSetChecker::threadJoined(ThreadId threadId, ThreadId childId) {
+
+}
+
+void LockSetChecker::lockAcquired(ThreadId threadId, ShadowLock::LockId lockId) {
 
-	if (event->getAccessInfo()->var->type == ShadowVar::STACK)
+	// LockSet_t = LockSet_t + {lock}	
+	lockSet_[threadId].insert(lockId);
+}
+
+void LockSetChecker::lockReleased(ThreadId threadId, ShadowLock::LockId lockId) {
+
+	// LockSet_t = LockSet_t - {lock}
+	lockSet_[threadId].erase(lockId);
+}
+
+void LockSetChecker::varAccessed(ThreadId threadId, RefId ref,
+								 ShadowVar::VarType varType,
+								 Access::type accessType,
+								 INS_ID instruction) {
+
+	if (varType == ShadowVar::STACK)
 		return;
 
-	switch(event->getAccessInfo()->type) {
+	switch(accessType) {
 	case Access::READ:
 		{
 			readVarSet_[ref][threadId].instruction = 
-				event->getAccessInfo()->instructionID;
+				instruction;
 
 			// R_x[t].lockset = LockSet_t
-			readVarSet_[ref][threadId].lockset = lockSet_[e->getThread()];
+			readVarSet_[ref][threadId].lockset = lockSet_[threadId];
 
 			if (lsIsEmptySet( readVarSet_[ref][threadId].lockset,
 								  writeVarSet_[ref].lockset) ) {
@@ -78,7 +106,7 @@ void LockSetChecker::access(const Event* e) {
 							std::unique_ptr<RaceEntry_>(new RaceEntry_(
 									WRITE_READ,
 									writeVarSet_[ref].instruction,
-									event->getAccessInfo()->instructionID,
+									instruction,
 									ref)
 							));
 					std::cout << "race detected..1" << std::endl;
@@ -89,7 +117,7 @@ void LockSetChecker::access(const Event* e) {
 	case Access::WRITE:
 		{	
 			// W_x.lockset = W_x.lockset intersect Lockset_t
-			lsIntersect(writeVarSet_[ref].lockset, lockSet_[e->getThread()]);
+			lsIntersect(writeVarSet_[ref].lockset, lockSet_[threadId]);
 
 			// check W_x.lockset = empty
 			if (writeVarSet_[ref].lockset.empty())	{
@@ -98,7 +126,7 @@ void LockSetChecker::access(const Event* e) {
 						std::unique_ptr<RaceEntry_>(new RaceEntry_(
 								WRITE_WRITE,
 								writeVarSet_[ref].instruction,
-								event->getAccessInfo()->instructionID,
+								instruction,
 								ref)
 						));
 				std::cout << "race detected..2" << std::endl;
@@ -166,3 +194,139 @@ void LockSetChecker::lsIntersect(LockSet_& lhs, const LockSet_& rhs) const {
 
 	lhs = result;
 }
+
+void LockSetChecker::serialize(rapidjson::Value& state,
+		rapidjson::Document::AllocatorType& allocator) const {
+
+	rapidjson::Value lockSets(rapidjson::kArrayType);
+	for (const auto& entry : lockSet_) {
+		rapidjson::Value lockSet(rapidjson::kArrayType);
+		lockSet.PushBack(entry.first, allocator);
+		lockSet.PushBack(lsSerialize(entry.second, allocator), allocator);
+		lockSets.PushBack(lockSet, allocator);
+	}
+
+	// [thread, instruction, lockset]
+	auto varSet = [&allocator](ThreadId threadId, const VarSet_& var) {
+		rapidjson::Value value(rapidjson::kArrayType);
+		value.PushBack(threadId, allocator);
+		value.PushBack(var.instruction, allocator);
+		value.PushBack(lsSerialize(var.lockset, allocator), allocator);
+		return value;
+	};
+
+	rapidjson::Value reads(rapidjson::kArrayType);
+	for (const auto& entry : readVarSet_) {
+		rapidjson::Value threads(rapidjson::kArrayType);
+		for (const auto& thread : entry.second)
+			threads.PushBack(varSet(thread.first, thread.second), allocator);
+		rapidjson::Value read(rapidjson::kArrayType);
+		read.PushBack(entry.first, allocator);
+		read.PushBack(threads, allocator);
+		reads.PushBack(read, allocator);
+	}
+
+	rapidjson::Value writes(rapidjson::kArrayType);
+	for (const auto& entry : writeVarSet_)
+		writes.PushBack(varSet(entry.first, entry.second), allocator);
+
+	rapidjson::Value races(rapidjson::kArrayType);
+	for (const auto& race : raceEntries_) {
+		rapidjson::Value value(rapidjson::kArrayType);
+		value.PushBack(race->type, allocator);
+		value.PushBack(race->firstInstruction, allocator);
+		value.PushBack(race->secondInstruction, allocator);
+		value.PushBack(race->id, allocator);
+		races.PushBack(value, allocator);
+	}
+
+	state.AddMember("lockSets", lockSets, allocator);
+	state.AddMember("reads", reads, allocator);
+	state.AddMember("writes", writes, allocator);
+	state.AddMember("races", races, allocator);
+}
+
+bool LockSetChecker::restore(const rapidjson::Value& state,
+								const ShadowIndex& shadows) {
+
+	for (auto name : { "lockSets", "reads", "writes", "races" }) {
+		if (!Checkpoint::hasArray(state, name))
+			return false;
+	}
+
+	const rapidjson::Value& lockSets = state["lockSets"];
+	for (rapidjson::SizeType i = 0; i < lockSets.Size(); ++i) {
+		const rapidjson::Value& value = lockSets[i];
+		if (!Checkpoint::isTuple(value, 2) || !value[0u].IsUint() ||
+			!lsRestore(value[1u], lockSet_[value[0u].GetUint()]))
+			return false;
+	}
+
+	// [thread, instruction, lockset]
+	auto varSet = [](const rapidjson::Value& value, VarSet_& var) {
+		if (!value[1u].IsUint64())
+			return false;
+		var.instruction = value[1u].GetUint64();
+		return lsRestore(value[2u], var.lockset);
+	};
+
+	const rapidjson::Value& reads = state["reads"];
+	for (rapidjson::SizeType i = 0; i < reads.Size(); ++i) {
+		if (!Checkpoint::isTuple(reads[i], 2) || !reads[i][0u].IsUint64() ||
+			!reads[i][1u].IsArray())
+			return false;
+		ThreadVarSet_& threads = readVarSet_[reads[i][0u].GetUint64()];
+		const rapidjson::Value& values = reads[i][1u];
+		for (rapidjson::SizeType j = 0; j < values.Size(); ++j) {
+			const rapidjson::Value& value = values[j];
+			if (!Checkpoint::isTuple(value, 3) || !value[0u].IsUint() ||
+				!varSet(value, threads[value[0u].GetUint()]))
+				return false;
+		}
+	}
+
+	const rapidjson::Value& writes = state["writes"];
+	for (rapidjson::SizeType i = 0; i < writes.Size(); ++i) {
+		const rapidjson::Value& value = writes[i];
+		if (!Checkpoint::isTuple(value, 3) || !value[0u].IsUint64() ||
+			!varSet(value, writeVarSet_[value[0u].GetUint64()]))
+			return false;
+	}
+
+	// [type, first instruction, second instruction, id]
+	const rapidjson::Value& races = state["races"];
+	for (rapidjson::SizeType i = 0; i < races.Size(); ++i) {
+		const rapidjson::Value& value = races[i];
+		if (!Checkpoint::isTuple(value, 4) || !value[0u].IsInt() ||
+			!value[1u].IsUint64() || !value[2u].IsUint64() ||
+			!value[3u].IsUint64())
+			return false;
+		raceEntries_.push_back(std::unique_ptr<RaceEntry_>(new RaceEntry_(
+				static_cast<RaceType>(value[0u].GetInt()),
+				value[1u].GetUint64(),
+				value[2u].GetUint64(),
+				value[3u].GetUint64())));
+	}
+	return true;
+}
+
+rapidjson::Value LockSetChecker::lsSerialize(const LockSet_& lockSet,
+		rapidjson::Document::AllocatorType& allocator) {
+
+	rapidjson::Value locks(rapidjson::kArrayType);
+	for (auto lock : lockSet)
+		locks.PushBack(lock, allocator);
+	return locks;
+}
+
+bool LockSetChecker::lsRestore(const rapidjson::Value& state, LockSet_& lockSet) {
+
+	if (!state.IsArray())
+		return false;
+	for (rapidjson::SizeType i = 0; i < state.Size(); ++i) {
+		if (!state[i].IsUint())
+			return false;
+		lockSet.insert(state[i].GetUint());
+	}
+	return true;
+}
@@ -35,6 +35,17 @@ public:
 	void release(const Event* e) override;
 	void access(const Event* e) override;
 	void call(const Event* e) override;
+	bool batched() const override { return true; }
+	void threadCreated(ThreadId threadId, ThreadId childId) override;
+	void threadJoined(ThreadId threadId, ThreadId childId) override;
+	void lockAcquired(ThreadId threadId, ShadowLock::LockId lockId) override;
+	void lockReleased(ThreadId threadId, ShadowLock::LockId lockId) override;
+	void varAccessed(ThreadId threadId, RefId ref, ShadowVar::VarType varType,
+					 Access::type accessType, INS_ID instruction) override;
+	void serialize(rapidjson::Value& state,
+				   rapidjson::Document::AllocatorType& allocator) const override;
+	bool restore(const rapidjson::Value& state,
+				 const ShadowIndex& shadows) override;
 	~LockSetChecker();
 
 	typedef enum { WRITE_READ = 1,		// read after write (RAW)
@@ -46,19 +57,17 @@ public:
 	
 private:
 	// Lock Set ---------------------------------------------------------------
-	struct ShadowLockPtrComp {
-		bool operator()(const ShadowLock* lhs, const ShadowLock* rhs) const {
-			return lhs->lockId < rhs->lockId;
-		}
-	};
-	
-	typedef std::set<ShadowLock*, ShadowLockPtrComp> LockSet_;
-	typedef std::map<const ShadowThread*, LockSet_> ThreadLockSet_;
+	typedef std::set<ShadowLock::LockId> LockSet_;
+	typedef std::map<ThreadId, LockSet_> ThreadLockSet_;
 	ThreadLockSet_ lockSet_;
 
 	inline bool lsIsEmptySet(const LockSet_& lhs, const LockSet_& rhs) const;
 	inline void lsIntersect(LockSet_& lhs, const LockSet_& rhs) const;
 
+	static rapidjson::Value lsSerialize(const LockSet_& lockSet,
+										rapidjson::Document::AllocatorType& allocator);
+	static bool lsRestore(const rapidjson::Value& state, LockSet_& lockSet);
+
 	
 	typedef struct VarSet_ {
 		LockSet_ lockset;
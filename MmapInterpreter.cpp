@@ -0,0 +1,259 @@
+/*
+ * MmapInterpreter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "MmapInterpreter.h"
+
+#include <boost/log/trivial.hpp>
+#include "Event.h"
+#include "EventService.h"
+#include "ShadowThread.h"
+#include "ShadowLock.h"
+#include "LockMgr.h"
+#include "ThreadMgr.h"
+#include "RunReport.h"
+
+MmapInterpreter::MmapInterpreter(const char* cachePath,
+								 const char* logFile,
+								 EventService *service,
+								 LockMgr *lockMgr,
+								 ThreadMgr *threadMgr)
+	: Interpreter(lockMgr, threadMgr, logFile), _cachePath(cachePath),
+	  _sourcePath(nullptr), _eventService(service), _events(ALL), _scope() { }
+
+MmapInterpreter::~MmapInterpreter() {
+
+	for (auto var : _shadowVars)
+		delete var;
+}
+
+EventService* MmapInterpreter::getEventService() {
+	return _eventService;
+}
+
+int MmapInterpreter::process() {
+
+	RunReport::Mark start = RunReport::now();
+	if (_cache.open(_cachePath, _sourcePath) != IN_OK)
+		return IN_ABORT;
+	if (report_ != nullptr)
+		report_->phase("load", start, _cache.count(TraceCache::INSTRUCTION_ID));
+
+	_events = _eventService->subscribedEvents();
+
+	if (restoreCheckpoint() != IN_OK)
+		return IN_ABORT;
+
+	_callThreads.assign(_cache.count(TraceCache::CALL_THREAD), nullptr);
+	_shadowVars.assign(_cache.count(TraceCache::REFERENCE_TYPE), nullptr);
+	_shadowLocks.assign(_cache.count(TraceCache::REFERENCE_TYPE), nullptr);
+
+	start = RunReport::now();
+	const INS_ID *ids = _cache.column<INS_ID>(TraceCache::INSTRUCTION_ID);
+	uint64_t nInstructions = _cache.count(TraceCache::INSTRUCTION_ID);
+	for (uint64_t ins = 0; ins < nInstructions; ++ins) {
+		if (isResumed(ids[ins]))
+			continue;
+		processInstruction(ins);
+		instructionDone(ids[ins]);
+	}
+	if (report_ != nullptr)
+		report_->phase("interpret", start, instructionsDone());
+
+	return IN_OK;
+}
+
+int MmapInterpreter::processInstruction(uint64_t ins) {
+
+	INS_ID insId = _cache.column<INS_ID>(TraceCache::INSTRUCTION_ID)[ins];
+	CAL_ID callId = _cache.column<CAL_ID>(TraceCache::INSTRUCTION_CALL)[ins];
+	uint8_t type = _cache.column<uint8_t>(TraceCache::INSTRUCTION_TYPE)[ins];
+
+	if ((instructionEvents(static_cast<Instruction::type>(type)) & _events) == 0)
+		return IN_OK;
+
+	if (callId == NO_ID32) {
+		if (type == Instruction::CALL) {
+			BOOST_LOG_TRIVIAL(error) << "Call not found for instruction: "
+									 << insId;
+			return IN_NO_ENTRY;
+		}
+		return IN_OK;
+	}
+
+	_scope.thread = _cache.column<TRD_TID>(TraceCache::CALL_THREAD)[callId];
+	_scope.function = _cache.column<FUN_ID>(TraceCache::CALL_FUNCTION)[callId];
+	_scope.file = _scope.function < _cache.count(TraceCache::FUNCTION_FILE) ?
+		_cache.column<FIL_ID>(TraceCache::FUNCTION_FILE)[_scope.function] : NO_ID32;
+
+	switch (type) {
+	case Instruction::CALL:
+		return processCall(insId, callId);
+	case Instruction::MEMACCESS:
+	case Instruction::ACQUIRE:
+	case Instruction::RELEASE:
+		return processAccesses(ins, callId);
+	case Instruction::FORK:
+	case Instruction::JOIN:
+		return processThread(ins, callId);
+	default:
+		return IN_NO_ENTRY;
+	}
+}
+
+int MmapInterpreter::processCall(INS_ID insId, CAL_ID callId) {
+
+	FUN_ID fnId = _cache.column<FUN_ID>(TraceCache::CALL_FUNCTION)[callId];
+	if (fnId >= _cache.count(TraceCache::FUNCTION_TYPE) ||
+		_cache.column<uint8_t>(TraceCache::FUNCTION_TYPE)[fnId] ==
+			TraceCache::NO_TYPE) {
+		BOOST_LOG_TRIVIAL(error) << "Function not found: " << fnId;
+		return IN_NO_ENTRY;
+	}
+
+	Function::type fnType = static_cast<Function::type>(
+		_cache.column<uint8_t>(TraceCache::FUNCTION_TYPE)[fnId]);
+	if (fnType != Function::FUNCTION && fnType != Function::METHOD)
+		return IN_OK;
+
+	FIL_ID fileId = _cache.column<FIL_ID>(TraceCache::FUNCTION_FILE)[fnId];
+	if (fileId >= _cache.count(TraceCache::FILE_NAME) ||
+		_cache.column<uint32_t>(TraceCache::FILE_NAME)[fileId] ==
+			TraceCache::NO_STRING) {
+		BOOST_LOG_TRIVIAL(error) << "File not found: " << fileId;
+		return 1;
+	}
+
+	CallInfo info( _cache.column<int32_t>(TraceCache::CALL_RUNTIME)[callId],
+				   _cache.string(_cache.column<uint32_t>(
+						TraceCache::FUNCTION_SIGNATURE)[fnId]),
+				   fnType,
+				   _cache.string(_cache.column<uint32_t>(
+						TraceCache::FILE_NAME)[fileId]),
+				   _cache.string(_cache.column<uint32_t>(
+						TraceCache::FILE_PATH)[fileId]));
+
+	CallEvent event(getShadowThread(callId), &info);
+	_eventService->publish(&event, &_scope);
+
+	return IN_OK;
+}
+
+int MmapInterpreter::processAccesses(uint64_t ins, CAL_ID callId) {
+
+	const ACC_ID *offsets =
+		_cache.column<ACC_ID>(TraceCache::INSTRUCTION_ACCESSES);
+	if (offsets[ins] == offsets[ins + 1]) {
+		BOOST_LOG_TRIVIAL(error) << "Access not found: "
+			<< _cache.column<INS_ID>(TraceCache::INSTRUCTION_ID)[ins];
+		return IN_NO_ENTRY;
+	}
+
+	INS_ID insId = _cache.column<INS_ID>(TraceCache::INSTRUCTION_ID)[ins];
+	Instruction::type insType = static_cast<Instruction::type>(
+		_cache.column<uint8_t>(TraceCache::INSTRUCTION_TYPE)[ins]);
+	const REF_ID *references =
+		_cache.column<REF_ID>(TraceCache::ACCESS_REFERENCE);
+
+	for (ACC_ID acc = offsets[ins]; acc < offsets[ins + 1]; ++acc) {
+		REF_ID refId = references[acc];
+		if (!hasReference(refId)) {
+			BOOST_LOG_TRIVIAL(error) << "Reference not found for access: "
+				<< _cache.column<ACC_ID>(TraceCache::ACCESS_ID)[acc];
+			continue;
+		}
+
+		switch (insType) {
+		case Instruction::MEMACCESS:
+		{
+			ShadowVar *var = getShadowVar(refId);
+			AccessInfo info( static_cast<Access::type>(
+								_cache.column<uint8_t>(TraceCache::ACCESS_TYPE)[acc]),
+							 var,
+							 insId);
+			AccessEvent event( getShadowThread(callId), &info );
+			_eventService->publish( &event, &_scope );
+			break;
+		}
+		case Instruction::ACQUIRE:
+		{
+			ShadowThread *thread = getShadowThread(callId);
+			AcquireInfo info(getShadowLock(refId));
+			AcquireEvent event( thread, &info );
+			_eventService->publish( &event, &_scope );
+			break;
+		}
+		default:
+		{
+			ShadowThread *thread = getShadowThread(callId);
+			ReleaseInfo info(getShadowLock(refId));
+			ReleaseEvent event( thread, &info );
+			_eventService->publish( &event, &_scope );
+			break;
+		}
+		}
+	}
+
+	return IN_OK;
+}
+
+int MmapInterpreter::processThread(uint64_t ins, CAL_ID callId) {
+
+	TRD_TID child = _cache.column<TRD_TID>(TraceCache::INSTRUCTION_CHILD)[ins];
+	if (child == NO_ID32)
+		return IN_OK;
+
+	ShadowThread *pT = getShadowThread(callId);
+	ShadowThread *cT = threadMgr_->getThread(child);
+	if (_cache.column<uint8_t>(TraceCache::INSTRUCTION_TYPE)[ins] ==
+		Instruction::FORK) {
+		NewThreadInfo info(cT);
+		NewThreadEvent event( pT, &info );
+		_eventService->publish( &event, &_scope );
+	} else {
+		JoinInfo info(cT);
+		JoinEvent event( pT, &info );
+		_eventService->publish( &event, &_scope );
+	}
+
+	return IN_OK;
+}
+
+ShadowThread* MmapInterpreter::getShadowThread(CAL_ID callId) {
+
+	ShadowThread *&thread = _callThreads[callId];
+	if (thread == nullptr)
+		thread = threadMgr_->getThread(
+			_cache.column<TRD_TID>(TraceCache::CALL_THREAD)[callId]);
+	return thread;
+}
+
+ShadowVar* MmapInterpreter::getShadowVar(REF_ID refId) {
+
+	ShadowVar *&var = _shadowVars[refId];
+	if (var == nullptr)
+		var = new ShadowVar( static_cast<ShadowVar::VarType>(
+								_cache.column<uint8_t>(TraceCache::REFERENCE_TYPE)[refId]),
+							 refId,
+							 _cache.column<REF_SIZE>(TraceCache::REFERENCE_SIZE)[refId],
+							 _cache.string(_cache.column<uint32_t>(
+								TraceCache::REFERENCE_NAME)[refId]));
+	return var;
+}
+
+ShadowLock* MmapInterpreter::getShadowLock(REF_ID refId) {
+
+	ShadowLock *&lock = _shadowLocks[refId];
+	if (lock == nullptr)
+		lock = lockMgr_->getLock(refId);
+	return lock;
+}
+
+bool MmapInterpreter::hasReference(REF_ID refId) const {
+
+	return refId < _cache.count(TraceCache::REFERENCE_TYPE) &&
+		   _cache.column<uint8_t>(TraceCache::REFERENCE_TYPE)[refId] !=
+				TraceCache::NO_TYPE;
+}
@@ -0,0 +1,71 @@
+/*
+ * MmapInterpreter.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef MMAPINTERPRETER_H_
+#define MMAPINTERPRETER_H_
+
+#include <vector>
+#include "Interpreter.h"
+#include "DBDataModel.h"
+#include "ShadowVar.h"
+#include "TraceCache.h"
+#include "Filter.h"
+
+class ShadowThread;
+class ShadowLock;
+
+/******************************************************************************
+ * MmapInterpreter
+ *
+ * Replays a trace cache written by DBInterpreter::setCacheFile. The cache
+ * is mapped read-only and interpreted in place; no SQLite or table load is
+ * involved. Publishes the same events as DBInterpreter. With a source set,
+ * only a cache written from that database is replayed.
+ *****************************************************************************/
+class MmapInterpreter : public Interpreter {
+public:
+	MmapInterpreter(const char* cachePath,
+					const char* logFile,
+					EventService *service,
+					LockMgr *lockMgr,
+					ThreadMgr *threadMgr);
+
+	int process() override;
+	EventService* getEventService() override;
+	~MmapInterpreter();
+
+	// the database the cache must have been written from
+	void setSource(const char* dbPath) { _sourcePath = dbPath; }
+
+private:
+	const char* _cachePath;
+	const char* _sourcePath;
+	EventService *_eventService;
+	TraceCache _cache;
+	int _events;	// union of the subscribed events
+	Filter::Scope _scope;	// scope of the instruction being interpreted
+
+	// shadow entities, created on first use
+	std::vector<ShadowThread*> _callThreads;	// by CAL_ID
+	std::vector<ShadowVar*> _shadowVars;		// by REF_ID
+	std::vector<ShadowLock*> _shadowLocks;		// by REF_ID
+
+	int processInstruction(uint64_t ins);
+	int processCall(INS_ID insId, CAL_ID callId);
+	int processAccesses(uint64_t ins, CAL_ID callId);
+	int processThread(uint64_t ins, CAL_ID callId);
+
+	ShadowThread* getShadowThread(CAL_ID callId);
+	ShadowVar* getShadowVar(REF_ID refId);
+	ShadowLock* getShadowLock(REF_ID refId);
+	bool hasReference(REF_ID refId) const;
+
+	// prevent generated functions
+	MmapInterpreter(const MmapInterpreter&);
+	MmapInterpreter& operator=(const MmapInterpreter&);
+};
+
+#endif /* MMAPINTERPRETER_H_ */
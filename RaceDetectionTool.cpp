@@ -14,6 +14,7 @@
 #include "ShadowThread.h"
 #include "ShadowVar.h"
 #include "ShadowLock.h"
+#include "Checkpoint.h"
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
@@ -31,64 +32,93 @@ RaceDetectionTool::~RaceDetectionTool() {
 
 void RaceDetectionTool::create(const Event* e) {
 
-   	ShadowThread* childThread = 
-		dynamic_cast<const NewThreadEvent*>(e)->getNewThreadInfo()->childThread;
+	threadCreated(e->getThread()->threadId,
+				  static_cast<const NewThreadEvent*>(e)->getNewThreadInfo()
+					  ->childThread->threadId);
+}
+
+void RaceDetectionTool::join(const Event* e) {
+
+	threadJoined(e->getThread()->threadId,
+				 static_cast<const JoinEvent*>(e)->getJoinInfo()
+					 ->childThread->threadId);
+}
+
+void RaceDetectionTool::acquire(const Event* e) {
+
+	lockAcquired(e->getThread()->threadId,
+				 static_cast<const AcquireEvent*>(e)->getAcquireInfo()
+					 ->lock->lockId);
+}
+
+void RaceDetectionTool::release(const Event* e) {
+
+	lockReleased(e->getThread()->threadId,
+				 static_cast<const ReleaseEvent*>(e)->getReleaseInfo()
+					 ->lock->lockId);
+}
+
+void RaceDetectionTool::access(const Event* e) {
+
+	const AccessInfo *info = static_cast<const AccessEvent*>(e)->getAccessInfo();
+	varAccessed(e->getThread()->threadId, info->var->id, info->var->type,
+				info->type, info->instructionID);
+}
+
+void RaceDetectionTool::threadCreated(ThreadId threadId, ThreadId childId) {
 
-	if (threadVC_.find(childThread->threadId) == threadVC_.end()) {
-		threadVC_[childThread->threadId].fill(0);
-		threadVC_[childThread->threadId][childThread->threadId] = 1;	
+	if (threadVC_.find(childId) == threadVC_.end()) {
+		threadVC_[childId].fill(0);
+		threadVC_[childId][childId] = 1;
 	}
 
 	// LockSet_u = set of all possible locks
-	lockSet_[childThread] =  lockSet_[e->getThread()];
+	lockSet_[childId] =  lockSet_[threadId];
 
 	// VC_u = Vc_u # VC_t
-	vcMerge( threadVC_[childThread->threadId],
-			 threadVC_[e->getThread()->threadId] );
+	vcMerge( threadVC_[childId], threadVC_[threadId] );
 
 	// VC_t[t] = VC_t[t] + 1
-	threadVC_[e->getThread()->threadId][e->getThread()->threadId]++;
+	threadVC_[threadId][threadId]++;
 }
 
-void RaceDetectionTool::join(const Event* e) {
+void RaceDetectionTool::threadJoined(ThreadId threadId, ThreadId childId) {
 
 	// VC_t = VC_t # VC_u
-	vcMerge( threadVC_[e->getThread()->threadId],
-		threadVC_[((JoinEvent*)e)->getJoinInfo()->childThread->threadId] );
+	vcMerge( threadVC_[threadId], threadVC_[childId] );
 
 	// VC_u[u] = VC_u[u] + 1
-	ThreadId id = ((JoinEvent*)e)->getJoinInfo()->childThread->threadId;
-	threadVC_[id][id]++;
+	threadVC_[childId][childId]++;
 }
 
-void RaceDetectionTool::acquire(const Event* e) {
+void RaceDetectionTool::lockAcquired(ThreadId threadId,
+									 ShadowLock::LockId lockId) {
 
 	// LockSet_t = LockSet_t + {lock}	
-	lockSet_[e->getThread()].insert(((AcquireEvent*)e)->getAcquireInfo()->lock);
+	lockSet_[threadId].insert(lockId);
 }
 
-void RaceDetectionTool::release(const Event* e) {
+void RaceDetectionTool::lockReleased(ThreadId threadId,
+									 ShadowLock::LockId lockId) {
 
 	// LockSet_t = LockSet_t - {lock}
-	auto lock = ((AcquireEvent*)e)->getAcquireInfo()->lock;
-	lockSet_[e->getThread()].erase(lock); 
+	lockSet_[threadId].erase(lockId);
 
 	// VC_t[t] = VC_t[t] + 1
-	threadVC_[e->getThread()->threadId][e->getThread()->threadId]++;
+	threadVC_[threadId][threadId]++;
 }
 
-void RaceDetectionTool::access(const Event* e) {
+void RaceDetectionTool::varAccessed(ThreadId threadId, RefId ref,
+									ShadowVar::VarType varType,
+									Access::type accessType,
+									INS_ID instruction) {
 
-	const AccessEvent *event = dynamic_cast<const AccessEvent*>(e);
-	const RefId ref = event->getAccessInfo()->var->id;
-	Epoch_ epoch(e->getThread()->threadId,
-				 threadVC_[e->getThread()->threadId][e->getThread()->threadId]);
-	const ThreadId threadId = event->getThread()->threadId;
+	Epoch_ epoch(threadId, threadVC_[threadId][threadId]);
 
-	if (event->getAccessInfo()->var->type == ShadowVar::STACK)
+	if (varType == ShadowVar::STACK)
 		return;
 
-	switch(event->getAccessInfo()->type) {
+	switch(accessType) {
 	case Access::READ:
 		{
 			
@@ -116,10 +146,10 @@ void RaceDetectionTool::access(const Event* e) {
 			// R_x[t].epoch = epoch(t)
 			readVarSet_[ref][threadId].epoch = epoch;
 			readVarSet_[ref][threadId].instruction = 
-				event->getAccessInfo()->instructionID;
+				instruction;
 
 			// R_x[t].lockset = LockSet_t
-			readVarSet_[ref][threadId].lockset = lockSet_[e->getThread()];
+			readVarSet_[ref][threadId].lockset = lockSet_[threadId];
 
 			// check if W_x.epoch > VC_t
 			if ( !vcLEQ(writeVarSet_[ref].epoch, threadVC_[threadId]) ) {
@@ -130,7 +160,7 @@ void RaceDetectionTool::access(const Event* e) {
 							std::unique_ptr<RaceEntry_>(new RaceEntry_(
 									WRITE_READ,
 									writeVarSet_[ref].instruction,
-									event->getAccessInfo()->instructionID,
+									instruction,
 									ref)
 							));
 					std::cout << "race detected..1" << std::endl;
@@ -149,7 +179,7 @@ void RaceDetectionTool::access(const Event* e) {
 		if ( !vcLEQ(writeVarSet_[ref].epoch, threadVC_[threadId]) ) {
 
 			// W_x.lockset = W_x.lockset intersect Lockset_t
-			lsIntersect(writeVarSet_[ref].lockset, lockSet_[e->getThread()]);
+			lsIntersect(writeVarSet_[ref].lockset, lockSet_[threadId]);
 
 			// check W_x.lockset = empty
 			if (writeVarSet_[ref].lockset.empty())	{
@@ -158,7 +188,7 @@ void RaceDetectionTool::access(const Event* e) {
 						std::unique_ptr<RaceEntry_>(new RaceEntry_(
 								WRITE_WRITE,
 								writeVarSet_[ref].instruction,
-								event->getAccessInfo()->instructionID,
+								instruction,
 								ref)
 						));
 				std::cout << "race detected..2" << std::endl;
@@ -167,12 +197,12 @@ void RaceDetectionTool::access(const Event* e) {
 		} else {
 
 			// W_x.lockset = Lockset_t
-			writeVarSet_[ref].lockset = lockSet_[e->getThread()];
+			writeVarSet_[ref].lockset = lockSet_[threadId];
 		}
 
 		// W_x.epoch = epoch(t)
 		writeVarSet_[ref].epoch = epoch;
-		writeVarSet_[ref].instruction = event->getAccessInfo()->instructionID;
+		writeVarSet_[ref].instruction = instruction;
 
 		// forall threads t' in read map R_x do
 		for (auto tp : readVarSet_[ref]) {
@@ -181,13 +211,13 @@ void RaceDetectionTool::access(const Event* e) {
 			if ( !vcLEQ(tp.second.epoch, threadVC_[threadId]) ) {
 				
 				// check R_x[t'].lockset intersect Lockset_t = empty
-				if ( lsIsEmptySet(readVarSet_[ref][tp.first].lockset, lockSet_[e->getThread()]) ) {
+				if ( lsIsEmptySet(readVarSet_[ref][tp.first].lockset, lockSet_[threadId]) ) {
 
 					raceEntries_.push_back(
 							std::unique_ptr<RaceEntry_>(new RaceEntry_(
 									READ_WRITE,
 									tp.second.instruction,
-									event->getAccessInfo()->instructionID,
+									instruction,
 									ref)
 							));
 					std::cout << "race detected..3" << std::endl;
@@ -293,3 +323,170 @@ void RaceDetectionTool::lsIntersect(LockSet_& lhs, const LockSet_& rhs) const {
 
 	lhs = result;
 }
+
+void RaceDetectionTool::serialize(rapidjson::Value& state,
+		rapidjson::Document::AllocatorType& allocator) const {
+
+	rapidjson::Value lockSets(rapidjson::kArrayType);
+	for (const auto& entry : lockSet_) {
+		rapidjson::Value lockSet(rapidjson::kArrayType);
+		lockSet.PushBack(entry.first, allocator);
+		lockSet.PushBack(lsSerialize(entry.second, allocator), allocator);
+		lockSets.PushBack(lockSet, allocator);
+	}
+
+	rapidjson::Value clocks(rapidjson::kArrayType);
+	for (const auto& entry : threadVC_) {
+		rapidjson::Value vc(rapidjson::kArrayType);
+		for (auto clock : entry.second)
+			vc.PushBack(clock, allocator);
+		rapidjson::Value threadVC(rapidjson::kArrayType);
+		threadVC.PushBack(entry.first, allocator);
+		threadVC.PushBack(vc, allocator);
+		clocks.PushBack(threadVC, allocator);
+	}
+
+	// [thread, epoch thread, epoch clock, instruction, lockset]
+	auto varSet = [&allocator](ThreadId threadId, const VarSet_& var) {
+		rapidjson::Value value(rapidjson::kArrayType);
+		value.PushBack(threadId, allocator);
+		value.PushBack(var.epoch.threadId, allocator);
+		value.PushBack(var.epoch.clock, allocator);
+		value.PushBack(var.instruction, allocator);
+		value.PushBack(lsSerialize(var.lockset, allocator), allocator);
+		return value;
+	};
+
+	rapidjson::Value reads(rapidjson::kArrayType);
+	for (const auto& entry : readVarSet_) {
+		rapidjson::Value threads(rapidjson::kArrayType);
+		for (const auto& thread : entry.second)
+			threads.PushBack(varSet(thread.first, thread.second), allocator);
+		rapidjson::Value read(rapidjson::kArrayType);
+		read.PushBack(entry.first, allocator);
+		read.PushBack(threads, allocator);
+		reads.PushBack(read, allocator);
+	}
+
+	rapidjson::Value writes(rapidjson::kArrayType);
+	for (const auto& entry : writeVarSet_)
+		writes.PushBack(varSet(entry.first, entry.second), allocator);
+
+	rapidjson::Value races(rapidjson::kArrayType);
+	for (const auto& race : raceEntries_) {
+		rapidjson::Value value(rapidjson::kArrayType);
+		value.PushBack(race->type, allocator);
+		value.PushBack(race->firstInstruction, allocator);
+		value.PushBack(race->secondInstruction, allocator);
+		value.PushBack(race->id, allocator);
+		races.PushBack(value, allocator);
+	}
+
+	state.AddMember("lockSets", lockSets, allocator);
+	state.AddMember("clocks", clocks, allocator);
+	state.AddMember("reads", reads, allocator);
+	state.AddMember("writes", writes, allocator);
+	state.AddMember("races", races, allocator);
+}
+
+bool RaceDetectionTool::restore(const rapidjson::Value& state,
+								const ShadowIndex& shadows) {
+
+	for (auto name : { "lockSets", "clocks", "reads", "writes", "races" }) {
+		if (!Checkpoint::hasArray(state, name))
+			return false;
+	}
+
+	const rapidjson::Value& lockSets = state["lockSets"];
+	for (rapidjson::SizeType i = 0; i < lockSets.Size(); ++i) {
+		const rapidjson::Value& value = lockSets[i];
+		if (!Checkpoint::isTuple(value, 2) || !value[0u].IsUint() ||
+			!lsRestore(value[1u], lockSet_[value[0u].GetUint()]))
+			return false;
+	}
+
+	const rapidjson::Value& clocks = state["clocks"];
+	for (rapidjson::SizeType i = 0; i < clocks.Size(); ++i) {
+		const rapidjson::Value& value = clocks[i];
+		if (!Checkpoint::isTuple(value, 2) || !value[0u].IsUint() ||
+			value[0u].GetUint() >= THREADS || !Checkpoint::isTuple(value[1u], THREADS))
+			return false;
+		VectorClock_& vc = threadVC_[value[0u].GetUint()];
+		for (rapidjson::SizeType j = 0; j < vc.size(); ++j) {
+			if (!value[1u][j].IsUint64())
+				return false;
+			vc[j] = value[1u][j].GetUint64();
+		}
+	}
+
+	// [thread, epoch thread, epoch clock, instruction, lockset]; the epoch
+	// thread indexes vector clocks
+	auto varSet = [](const rapidjson::Value& value, VarSet_& var) {
+		if (!value[1u].IsUint() || value[1u].GetUint() >= THREADS ||
+			!value[2u].IsUint64() || !value[3u].IsUint64())
+			return false;
+		var.epoch.set(value[1u].GetUint(), value[2u].GetUint64());
+		var.instruction = value[3u].GetUint64();
+		return lsRestore(value[4u], var.lockset);
+	};
+
+	const rapidjson::Value& reads = state["reads"];
+	for (rapidjson::SizeType i = 0; i < reads.Size(); ++i) {
+		if (!Checkpoint::isTuple(reads[i], 2) || !reads[i][0u].IsUint64() ||
+			!reads[i][1u].IsArray())
+			return false;
+		ThreadVarSet_& threads = readVarSet_[reads[i][0u].GetUint64()];
+		const rapidjson::Value& values = reads[i][1u];
+		for (rapidjson::SizeType j = 0; j < values.Size(); ++j) {
+			const rapidjson::Value& value = values[j];
+			if (!Checkpoint::isTuple(value, 5) || !value[0u].IsUint() ||
+				!varSet(value, threads[value[0u].GetUint()]))
+				return false;
+		}
+	}
+
+	const rapidjson::Value& writes = state["writes"];
+	for (rapidjson::SizeType i = 0; i < writes.Size(); ++i) {
+		const rapidjson::Value& value = writes[i];
+		if (!Checkpoint::isTuple(value, 5) || !value[0u].IsUint64() ||
+			!varSet(value, writeVarSet_[value[0u].GetUint64()]))
+			return false;
+	}
+
+	// [type, first instruction, second instruction, id]
+	const rapidjson::Value& races = state["races"];
+	for (rapidjson::SizeType i = 0; i < races.Size(); ++i) {
+		const rapidjson::Value& value = races[i];
+		if (!Checkpoint::isTuple(value, 4) || !value[0u].IsInt() ||
+			!value[1u].IsUint64() || !value[2u].IsUint64() ||
+			!value[3u].IsUint64())
+			return false;
+		raceEntries_.push_back(std::unique_ptr<RaceEntry_>(new RaceEntry_(
+				static_cast<RaceType>(value[0u].GetInt()),
+				value[1u].GetUint64(),
+				value[2u].GetUint64(),
+				value[3u].GetUint64())));
+	}
+	return true;
+}
+
+rapidjson::Value RaceDetectionTool::lsSerialize(const LockSet_& lockSet,
+		rapidjson::Document::AllocatorType& allocator) {
+
+	rapidjson::Value locks(rapidjson::kArrayType);
+	for (auto lock : lockSet)
+		locks.PushBack(lock, allocator);
+	return locks;
+}
+
+bool RaceDetectionTool::lsRestore(const rapidjson::Value& state, LockSet_& lockSet) {
+
+	if (!state.IsArray())
+		return false;
+	for (rapidjson::SizeType i = 0; i < state.Size(); ++i) {
+		if (!state[i].IsUint())
+			return false;
+		lockSet.insert(state[i].GetUint());
+	}
+	return true;
+}
@@ -0,0 +1,26 @@
+#include <new>
+#include <utility>
+
+template<typename T, std::size_t BlockRows>
+RowArena<T, BlockRows>::RowArena() : size_(0) {}
+
+template<typename T, std::size_t BlockRows>
+RowArena<T, BlockRows>::~RowArena() {
+
+	for (std::size_t pos = 0; pos < size_; ++pos)
+		(*this)[pos].~T();
+	for (auto block : blocks_)
+		::operator delete(block);
+}
+
+template<typename T, std::size_t BlockRows>
+template<typename... Args>
+T* RowArena<T, BlockRows>::emplace(Args&&... args) {
+
+	if (size_ == blocks_.size() * BlockRows)
+		blocks_.push_back(static_cast<T*>(::operator new(BlockRows * sizeof(T))));
+
+	T *row = new (&(*this)[size_]) T(std::forward<Args>(args)...);
+	++size_;
+	return row;
+}
@@ -0,0 +1,45 @@
+/*
+ * RowArena.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef ROWARENA_H_
+#define ROWARENA_H_
+
+#include <cstddef>
+#include <vector>
+
+/******************************************************************************
+ * RowArena
+ *
+ * Append-only storage for the rows of a table. Rows are constructed in
+ * place inside blocks of BlockRows rows that never move, so pointers to a
+ * row stay valid until the arena is destroyed, and all rows are released
+ * together.
+ *****************************************************************************/
+template<typename T, std::size_t BlockRows = 4096>
+class RowArena {
+public:
+	RowArena();
+	~RowArena();
+
+	template<typename... Args>
+	T* emplace(Args&&... args);
+
+	T& operator[](std::size_t pos) { return blocks_[pos / BlockRows][pos % BlockRows]; }
+	const T& operator[](std::size_t pos) const { return blocks_[pos / BlockRows][pos % BlockRows]; }
+	std::size_t size() const { return size_; }
+
+private:
+	std::vector<T*> blocks_;
+	std::size_t size_;
+
+	// prevent generated functions
+	RowArena(const RowArena&);
+	RowArena& operator=(const RowArena&);
+};
+
+#include "RowArena-inl.h"
+
+#endif /* ROWARENA_H_ */
@@ -0,0 +1,134 @@
+/*
+ * RunReport.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "RunReport.h"
+
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "Interpreter.h"
+
+static double seconds(RunReport::Time start, RunReport::Time end) {
+	return std::chrono::duration<double>(end - start).count();
+}
+
+static double perSecond(unsigned long count, double seconds) {
+	return seconds > 0 ? count / seconds : 0;
+}
+
+RunReport::Mark RunReport::now() {
+
+	Mark mark;
+	mark.time = std::chrono::steady_clock::now();
+	mark.resident = residentBytes();
+	return mark;
+}
+
+long RunReport::residentBytes() {
+
+	long pages = 0, resident = 0;
+	std::ifstream statm("/proc/self/statm");
+	if (!(statm >> pages >> resident))
+		return 0;
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+void RunReport::table(const std::string& name, unsigned long rows,
+					  unsigned long bytes, Time start) {
+
+	Time end = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(mutex_);
+	Table_& table = tables_[name];
+	table.rows += rows;
+	table.bytes += bytes;
+	table.first = table.read ? std::min(table.first, start) : start;
+	table.last = table.read ? std::max(table.last, end) : end;
+	table.read = true;
+}
+
+void RunReport::retained(const std::string& name, std::size_t bytes) {
+
+	if (bytes == 0)		// not loaded
+		return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	tables_[name].retained = bytes;
+}
+
+void RunReport::phase(const std::string& name, const Mark& start,
+					  unsigned long rows, unsigned long bytes) {
+
+	Mark end = now();
+	Phase_ phase;
+	phase.name = name;
+	phase.seconds = seconds(start.time, end.time);
+	phase.rows = rows;
+	phase.bytes = bytes;
+	phase.memoryDelta = end.resident - start.resident;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	phases_.push_back(phase);
+}
+
+int RunReport::write(const char *path) const {
+
+	rapidjson::Document doc;
+	doc.SetObject();
+	rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	rapidjson::Value tables(rapidjson::kArrayType);
+	for (const auto& entry : tables_) {
+		const Table_& table = entry.second;
+		double duration = table.read ? seconds(table.first, table.last) : 0;
+		rapidjson::Value value(rapidjson::kObjectType);
+		value.AddMember("name", rapidjson::Value(entry.first.c_str(), allocator),
+						allocator);
+		value.AddMember("rows", static_cast<uint64_t>(table.rows), allocator);
+		value.AddMember("bytes", static_cast<uint64_t>(table.bytes), allocator);
+		value.AddMember("seconds", duration, allocator);
+		value.AddMember("rowsPerSecond", perSecond(table.rows, duration), allocator);
+		value.AddMember("retained", static_cast<uint64_t>(table.retained),
+						allocator);
+		tables.PushBack(value, allocator);
+	}
+
+	rapidjson::Value phases(rapidjson::kArrayType);
+	for (const auto& phase : phases_) {
+		rapidjson::Value value(rapidjson::kObjectType);
+		value.AddMember("name", rapidjson::Value(phase.name.c_str(), allocator),
+						allocator);
+		value.AddMember("seconds", phase.seconds, allocator);
+		value.AddMember("rows", static_cast<uint64_t>(phase.rows), allocator);
+		value.AddMember("rowsPerSecond", perSecond(phase.rows, phase.seconds),
+						allocator);
+		value.AddMember("bytes", static_cast<uint64_t>(phase.bytes), allocator);
+		value.AddMember("memoryDelta", static_cast<int64_t>(phase.memoryDelta),
+						allocator);
+		phases.PushBack(value, allocator);
+	}
+
+	doc.AddMember("tables", tables, allocator);
+	doc.AddMember("phases", phases, allocator);
+	doc.AddMember("resident", static_cast<int64_t>(residentBytes()), allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	std::ofstream file(path, std::ios::trunc);
+	file << buffer.GetString();
+	file.close();
+	if (file.fail()) {
+		BOOST_LOG_TRIVIAL(error) << "Can't write run report " << path;
+		return IN_ABORT;
+	}
+	return IN_OK;
+}
@@ -0,0 +1,77 @@
+/*
+ * RunReport.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef RUNREPORT_H_
+#define RUNREPORT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/******************************************************************************
+ * RunReport
+ *
+ * Collects how long a run spends in every table and phase and writes it
+ * as a JSON summary at the end. Tables count the rows and bytes decoded
+ * from the database; a table read by several workers spans from the first
+ * start to the last end. Phases (load, index, link, cache, interpret,
+ * dump) record their duration and the change of the resident set size.
+ * Phases may overlap: the access index is built within the load phase.
+ * Methods may be called from several threads.
+ *****************************************************************************/
+class RunReport {
+public:
+	typedef std::chrono::steady_clock::time_point Time;
+
+	typedef struct Mark {
+		Time time;
+		long resident;	// bytes
+	} Mark;
+
+	RunReport() {}
+
+	static Mark now();
+	static long residentBytes();	// 0 if unknown
+
+	void table(const std::string& name, unsigned long rows, unsigned long bytes,
+			   Time start);
+	void retained(const std::string& name, std::size_t bytes);
+	void phase(const std::string& name, const Mark& start, unsigned long rows,
+			   unsigned long bytes = 0);
+
+	int write(const char *path) const;
+
+private:
+	typedef struct Table_ {
+		unsigned long rows;
+		unsigned long bytes;
+		std::size_t retained;	// bytes kept by the loaded table
+		Time first, last;
+		bool read;
+		Table_() : rows(0), bytes(0), retained(0), read(false) {}
+	} Table_;
+
+	typedef struct Phase_ {
+		std::string name;
+		double seconds;
+		unsigned long rows;
+		unsigned long bytes;
+		long memoryDelta;
+	} Phase_;
+
+	mutable std::mutex mutex_;
+	std::map<std::string, Table_> tables_;
+	std::vector<Phase_> phases_;
+
+	// prevent generated functions
+	RunReport(const RunReport&);
+	RunReport& operator=(const RunReport&);
+};
+
+#endif /* RUNREPORT_H_ */
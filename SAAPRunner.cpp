@@ -32,6 +32,7 @@ bool SAAPRunner::removeTool(Tool* tool)
 void SAAPRunner::interpret()
 {
 	_interpreter->process();
+	_interpreter->getEventService()->flush();
 }
 
 //class SAAPRunner {
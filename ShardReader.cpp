@@ -0,0 +1,163 @@
+/*
+ * ShardReader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "ShardReader.h"
+
+#include <boost/log/trivial.hpp>
+#include "Interpreter.h"
+
+// columns of the stream query read as text, the others are integers
+static const uint32_t kTextColumns =
+	1u << 2 | 1u << 4 | 1u << 6 | 1u << 12 | 1u << 13 | 1u << 16 | 1u << 17 |
+	1u << 18 | 1u << 21 | 1u << 22 | 1u << 27 | 1u << 28 | 1u << 30 | 1u << 31;
+
+ShardReader::ShardReader(sqlite3 *db, sqlite3_stmt *stmt, const Offsets& offsets,
+						 References references)
+	: db_(db), stmt_(stmt), offsets_(offsets),
+	  references_(std::move(references)), done_(false), cancelled_(false),
+	  status_(IN_OK), index_(0) { }
+
+ShardReader::~ShardReader() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		cancelled_ = true;
+	}
+	changed_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+
+	sqlite3_finalize(stmt_);
+	sqlite3_close(db_);
+}
+
+void ShardReader::start() {
+
+	thread_ = std::thread(&ShardReader::read, this);
+}
+
+bool ShardReader::next() {
+
+	if (current_ && ++index_ < current_->keys.size()) {
+		row_ = Row(&current_->values[index_ * COLUMNS], current_->text.data());
+		return true;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	changed_.wait(lock, [this] { return !queue_.empty() || done_; });
+	if (queue_.empty()) {
+		current_.reset();
+		return false;
+	}
+	current_ = std::move(queue_.front());
+	queue_.pop_front();
+	lock.unlock();
+	changed_.notify_all();
+
+	index_ = 0;
+	row_ = Row(&current_->values[0], current_->text.data());
+	return true;
+}
+
+void ShardReader::read() {
+
+	int rc = IN_OK;
+	bool reading = true;
+	while (reading) {
+		std::unique_ptr<Block> block(new Block());
+		block->values.reserve(BLOCK_ROWS * COLUMNS);
+		block->keys.reserve(BLOCK_ROWS);
+
+		while (block->keys.size() < BLOCK_ROWS) {
+			int step = sqlite3_step(stmt_);
+			if (step == SQLITE_ROW) {
+				decode(block.get());
+				continue;
+			}
+			if (step != SQLITE_DONE) {
+				BOOST_LOG_TRIVIAL(error) << "Iterating shard failed: "
+										 << sqlite3_errmsg(db_);
+				rc = IN_ABORT;
+			}
+			reading = false;
+			break;
+		}
+
+		if (!block->keys.empty() && !push(block))
+			reading = false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		status_ = rc;
+		done_ = true;
+	}
+	changed_.notify_all();
+}
+
+void ShardReader::decode(Block *block) {
+
+	block->keys.push_back(sqlite3_column_int64(stmt_, 0));
+
+	for (int col = 0; col < COLUMNS; ++col) {
+		Value value;
+		value.type = sqlite3_column_type(stmt_, col);
+		if (value.type == SQLITE_NULL) {
+			value.integer = 0;
+		} else if (kTextColumns & (1u << col)) {
+			const unsigned char *text = sqlite3_column_text(stmt_, col);
+			value.type = SQLITE_TEXT;
+			value.integer = block->text.size();
+			block->text.append((const char*)text, sqlite3_column_bytes(stmt_, col));
+			block->text.push_back('\0');
+		} else {
+			value.type = SQLITE_INTEGER;
+			value.integer = sqlite3_column_int64(stmt_, col);
+			switch (col) {
+			case 0:		// instruction
+			case 11:	// instruction of the call
+			case 23:	// allocating instruction
+				value.integer += offsets_.instruction;
+				break;
+			case 1:		// segment
+				value.integer += offsets_.segment;
+				break;
+			case 14:	// access
+				value.integer += offsets_.access;
+				break;
+			case 9:		// thread of the call
+			case 25:	// parent thread
+			case 26:	// child thread
+				value.integer += offsets_.thread;
+				break;
+			case 19:	// reference
+				{
+					auto search = references_.find(value.integer);
+					if (search != references_.end())
+						value.integer = search->second;
+					else
+						value.integer += offsets_.reference;
+				}
+				break;
+			}
+		}
+		block->values.push_back(value);
+	}
+}
+
+bool ShardReader::push(std::unique_ptr<Block>& block) {
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	changed_.wait(lock, [this] {
+		return queue_.size() < QUEUE_BLOCKS || cancelled_;
+	});
+	if (cancelled_)
+		return false;
+	queue_.push_back(std::move(block));
+	lock.unlock();
+	changed_.notify_all();
+	return true;
+}
@@ -0,0 +1,121 @@
+/*
+ * ShardReader.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SHARDREADER_H_
+#define SHARDREADER_H_
+
+#include <sqlite3.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "DBDataModel.h"
+
+/******************************************************************************
+ * ShardReader
+ *
+ * Steps the stream query (see DBInterpreter::streamQuery) of one trace
+ * shard on its own thread and decodes the rows into blocks, with the
+ * shard's id offsets and reference ids applied. Blocks are handed over
+ * through a bounded queue, so decoding runs ahead of the merge by at most a
+ * few blocks.
+ *****************************************************************************/
+class ShardReader {
+public:
+	static const int COLUMNS = 32;			// columns of the stream query
+	static const size_t BLOCK_ROWS = 4096;
+	static const size_t QUEUE_BLOCKS = 4;
+
+	// added to the ids of the shard to put them into one namespace
+	typedef struct Offsets {
+		INS_ID instruction;
+		SEG_ID segment;
+		ACC_ID access;
+		TRD_TID thread;
+		REF_ID reference;	// of the ids missing in References
+	} Offsets;
+
+	// reference ids of the merged trace by the ids in the shard
+	typedef std::unordered_map<REF_ID, REF_ID> References;
+
+	typedef struct Value {
+		sqlite3_int64 integer;	// or offset into the text of the block
+		int type;				// SQLITE_NULL, SQLITE_TEXT or SQLITE_INTEGER
+	} Value;
+
+	// decoded rows and their text, in shard order
+	typedef struct Block {
+		std::vector<Value> values;		// COLUMNS per row
+		std::vector<INS_ID> keys;		// instruction id as in the shard
+		std::string text;
+	} Block;
+
+	// one decoded row, valid until the reader is advanced
+	class Row {
+	public:
+		Row() : values_(nullptr), text_(nullptr) {}
+		Row(const Value *values, const char *text)
+			: values_(values), text_(text) {}
+
+		bool isNull(int col) const { return values_[col].type == SQLITE_NULL; }
+		sqlite3_int64 getInt(int col) const { return values_[col].integer; }
+		const unsigned char* getText(int col) const {
+			return isNull(col) ? nullptr :
+				(const unsigned char*)(text_ + values_[col].integer);
+		}
+
+	private:
+		const Value *values_;
+		const char *text_;
+	};
+
+	// takes ownership of the prepared statement and its connection
+	ShardReader(sqlite3 *db, sqlite3_stmt *stmt, const Offsets& offsets,
+				References references);
+	~ShardReader();
+
+	void start();
+
+	// advance to the next row; false at the end of the shard or on errors
+	bool next();
+	const Row& row() const { return row_; }
+	INS_ID key() const { return current_->keys[index_]; }
+	int status() const { return status_; }
+
+private:
+	sqlite3 *db_;
+	sqlite3_stmt *stmt_;
+	const Offsets offsets_;
+	const References references_;
+	std::thread thread_;
+
+	// handover; guarded by mutex_
+	std::mutex mutex_;
+	std::condition_variable changed_;
+	std::deque<std::unique_ptr<Block>> queue_;
+	bool done_;
+	bool cancelled_;
+	int status_;
+
+	// consumer side
+	std::unique_ptr<Block> current_;
+	size_t index_;
+	Row row_;
+
+	void read();
+	void decode(Block *block);
+	bool push(std::unique_ptr<Block>& block);
+
+	// prevent generated functions
+	ShardReader(const ShardReader&);
+	ShardReader& operator=(const ShardReader&);
+};
+
+#endif /* SHARDREADER_H_ */
@@ -0,0 +1,45 @@
+#include <algorithm>
+
+static inline std::size_t ringCapacity(std::size_t capacity) {
+
+	std::size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+	return size;
+}
+
+template<typename T>
+SpscRing<T>::SpscRing(std::size_t capacity)
+	: slots_(ringCapacity(capacity)), mask_(slots_.size() - 1), head_(0),
+	  tail_(0) {}
+
+template<typename T>
+std::size_t SpscRing<T>::push(const T *items, std::size_t count) {
+
+	std::size_t tail = tail_.load(std::memory_order_relaxed);
+	std::size_t head = head_.load(std::memory_order_acquire);
+	count = std::min(count, slots_.size() - (tail - head));
+	for (std::size_t i = 0; i < count; ++i)
+		slots_[(tail + i) & mask_] = items[i];
+	tail_.store(tail + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+std::size_t SpscRing<T>::pop(T *items, std::size_t max) {
+
+	std::size_t head = head_.load(std::memory_order_relaxed);
+	std::size_t tail = tail_.load(std::memory_order_acquire);
+	std::size_t count = std::min(max, tail - head);
+	for (std::size_t i = 0; i < count; ++i)
+		items[i] = slots_[(head + i) & mask_];
+	head_.store(head + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+bool SpscRing<T>::empty() const {
+
+	return head_.load(std::memory_order_acquire) ==
+		   tail_.load(std::memory_order_acquire);
+}
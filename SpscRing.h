@@ -0,0 +1,50 @@
+/*
+ * SpscRing.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/******************************************************************************
+ * SpscRing
+ *
+ * Bounded lock-free queue of trivially copyable items between exactly one
+ * producer thread and one consumer thread. push() and pop() move as many
+ * items as fit and publish them with one atomic store, so items are best
+ * moved in chunks. The capacity is rounded up to a power of two.
+ *****************************************************************************/
+template<typename T>
+class SpscRing {
+public:
+	explicit SpscRing(std::size_t capacity);
+
+	std::size_t push(const T *items, std::size_t count);	// producer
+	std::size_t pop(T *items, std::size_t max);				// consumer
+	bool empty() const;
+
+private:
+	// head and tail on cache lines of their own (C++11 new ignores alignas)
+	enum { CACHE_LINE = 64 };
+
+	std::vector<T> slots_;
+	const std::size_t mask_;
+	char pad0_[CACHE_LINE];
+	std::atomic<std::size_t> head_;	// next item to pop
+	char pad1_[CACHE_LINE - sizeof(std::atomic<std::size_t>)];
+	std::atomic<std::size_t> tail_;	// next slot to push
+	char pad2_[CACHE_LINE - sizeof(std::atomic<std::size_t>)];
+
+	// prevent generated functions
+	SpscRing(const SpscRing&);
+	SpscRing& operator=(const SpscRing&);
+};
+
+#include "SpscRing-inl.h"
+
+#endif /* SPSCRING_H_ */
@@ -0,0 +1,116 @@
+// expands a call for every subscription, in order
+#define SAAP_EXPAND(call) { int expand[] = { 0, ((call), 0)... }; (void)expand; }
+
+template<typename ToolT, int Mask>
+bool Subscription<ToolT, Mask>::accepts(const Filter::Scope *scope) const {
+
+	return filter_ == nullptr || scope == nullptr || filter_->accepts(*scope);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::create(const NewThreadEvent *event,
+									   const Filter::Scope *scope) const {
+
+	if ((Mask & NEWTHREAD) && accepts(scope))
+		tool_->ToolT::create(event);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::join(const JoinEvent *event,
+									 const Filter::Scope *scope) const {
+
+	if ((Mask & JOIN) && accepts(scope))
+		tool_->ToolT::join(event);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::acquire(const AcquireEvent *event,
+										const Filter::Scope *scope) const {
+
+	if ((Mask & ACQUIRE) && accepts(scope))
+		tool_->ToolT::acquire(event);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::release(const ReleaseEvent *event,
+										const Filter::Scope *scope) const {
+
+	if ((Mask & RELEASE) && accepts(scope))
+		tool_->ToolT::release(event);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::access(const AccessEvent *event,
+									   const Filter::Scope *scope) const {
+
+	if ((Mask & ACCESS) && accepts(scope) &&
+		(filter_ == nullptr ||
+		 filter_->acceptsMemoryType(event->getAccessInfo()->var->type)))
+		tool_->ToolT::access(event);
+}
+
+template<typename ToolT, int Mask>
+void Subscription<ToolT, Mask>::call(const CallEvent *event,
+									 const Filter::Scope *scope) const {
+
+	if ((Mask & CALL) && accepts(scope))
+		tool_->ToolT::call(event);
+}
+
+template<typename... Subs>
+StaticEventService<Subs...>::StaticEventService(const Subs&... subscriptions)
+	: EventService(), Subs(subscriptions)... {
+
+	SAAP_EXPAND(subscribe(subscriptions.tool(), subscriptions.filter(),
+						  static_cast<Events>(Subs::EVENTS)));
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(NewThreadEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::create(event, scope));
+	return true;
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(JoinEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::join(event, scope));
+	return true;
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(AcquireEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::acquire(event, scope));
+	return true;
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(ReleaseEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::release(event, scope));
+	return true;
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(AccessEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::access(event, scope));
+	return true;
+}
+
+template<typename... Subs>
+bool StaticEventService<Subs...>::publish(CallEvent *event,
+										  const Filter::Scope *scope) {
+
+	SAAP_EXPAND(Subs::call(event, scope));
+	return true;
+}
+
+#undef SAAP_EXPAND
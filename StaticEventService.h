@@ -0,0 +1,75 @@
+/*
+ * StaticEventService.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef STATICEVENTSERVICE_H_
+#define STATICEVENTSERVICE_H_
+
+#include "EventService.h"
+#include "ShadowVar.h"
+
+/******************************************************************************
+ * Subscription
+ *
+ * A tool of a concrete type subscribed to the events of Mask (see enum
+ * Events). Events outside the mask compile to nothing; the others call
+ * the tool's own member functions directly, bypassing the Tool vtable.
+ *****************************************************************************/
+template<typename ToolT, int Mask>
+class Subscription {
+public:
+	static const int EVENTS = Mask;
+
+	Subscription(ToolT *tool, const Filter *filter = nullptr)
+		: tool_(tool), filter_(filter) {}
+
+	ToolT* tool() const { return tool_; }
+	const Filter* filter() const { return filter_; }
+
+	inline void create(const NewThreadEvent *event, const Filter::Scope *scope) const;
+	inline void join(const JoinEvent *event, const Filter::Scope *scope) const;
+	inline void acquire(const AcquireEvent *event, const Filter::Scope *scope) const;
+	inline void release(const ReleaseEvent *event, const Filter::Scope *scope) const;
+	inline void access(const AccessEvent *event, const Filter::Scope *scope) const;
+	inline void call(const CallEvent *event, const Filter::Scope *scope) const;
+
+private:
+	ToolT *tool_;
+	const Filter *filter_;
+
+	inline bool accepts(const Filter::Scope *scope) const;
+};
+
+/******************************************************************************
+ * StaticEventService
+ *
+ * Event service for a tool set fixed at compile time. Each publish visits
+ * the subscriptions in the order given and only reaches the tools whose
+ * mask contains the event, without virtual calls into the tools. The
+ * tools are also registered with the runtime EventService, so the
+ * interpreters still see their events, filters and checkpoint state.
+ * Every tool type may appear once.
+ *****************************************************************************/
+template<typename... Subs>
+class StaticEventService : public EventService, private Subs... {
+public:
+	explicit StaticEventService(const Subs&... subscriptions);
+
+	bool publish(NewThreadEvent *event, const Filter::Scope *scope = nullptr) override;
+	bool publish(JoinEvent *event, const Filter::Scope *scope = nullptr) override;
+	bool publish(AcquireEvent *event, const Filter::Scope *scope = nullptr) override;
+	bool publish(ReleaseEvent *event, const Filter::Scope *scope = nullptr) override;
+	bool publish(AccessEvent *event, const Filter::Scope *scope = nullptr) override;
+	bool publish(CallEvent *event, const Filter::Scope *scope = nullptr) override;
+
+private:
+	// prevent generated functions
+	StaticEventService(const StaticEventService&);
+	StaticEventService& operator=(const StaticEventService&);
+};
+
+#include "StaticEventService-inl.h"
+
+#endif /* STATICEVENTSERVICE_H_ */
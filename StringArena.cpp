@@ -0,0 +1,96 @@
+/*
+ * StringArena.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "StringArena.h"
+
+#include <cstring>
+
+static const char kEmpty[] = "";
+
+StringArena::StringArena(std::size_t blockSize)
+	: blockSize_(blockSize), cur_(nullptr), left_(0), bytes_(0) {}
+
+StringArena::~StringArena() {
+
+	for (auto block : blocks_)
+		delete[] block;
+}
+
+char* StringArena::allocate(std::size_t len) {
+
+	// oversized strings get a block of their own; the current one stays open
+	if (len > blockSize_) {
+		char *block = new char[len];
+		blocks_.push_back(block);
+		bytes_ += len;
+		return block;
+	}
+
+	if (len > left_) {
+		cur_ = new char[blockSize_];
+		left_ = blockSize_;
+		blocks_.push_back(cur_);
+	}
+
+	char *result = cur_;
+	cur_ += len;
+	left_ -= len;
+	bytes_ += len;
+	return result;
+}
+
+const char* StringArena::store(const char *str) {
+
+	if (str == nullptr || *str == '\0')
+		return kEmpty;
+
+	std::size_t len = strlen(str) + 1;
+	char *copy = allocate(len);
+	memcpy(copy, str, len);
+	return copy;
+}
+
+const char* StringArena::intern(const char *str) {
+
+	if (str == nullptr || *str == '\0')
+		return kEmpty;
+
+	auto search = interned_.find(str);
+	if (search != interned_.end())
+		return *search;
+
+	const char *copy = store(str);
+	interned_.insert(copy);
+	return copy;
+}
+
+void StringArena::absorb(StringArena& other) {
+
+	blocks_.insert(blocks_.end(), other.blocks_.begin(), other.blocks_.end());
+	bytes_ += other.bytes_;
+	interned_.insert(other.interned_.begin(), other.interned_.end());
+
+	other.blocks_.clear();
+	other.cur_ = nullptr;
+	other.left_ = 0;
+	other.bytes_ = 0;
+	other.interned_.clear();
+}
+
+std::size_t StringArena::CStrHash::operator()(const char *str) const {
+
+	// FNV-1a
+	std::size_t hash = 2166136261u;
+	for (; *str != '\0'; ++str) {
+		hash ^= static_cast<unsigned char>(*str);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool StringArena::CStrEqual::operator()(const char *lhs, const char *rhs) const {
+	return strcmp(lhs, rhs) == 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * StringArena.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef STRINGARENA_H_
+#define STRINGARENA_H_
+
+#include <cstddef>
+#include <vector>
+#include <unordered_set>
+
+/******************************************************************************
+ * StringArena
+ *
+ * Append-only storage for the text columns of loaded rows. Strings are
+ * copied once into large blocks that never move, so rows can keep plain
+ * const char* views for as long as the arena lives. intern() additionally
+ * returns the same view for equal strings.
+ *****************************************************************************/
+class StringArena {
+public:
+	StringArena(std::size_t blockSize = 64 * 1024);
+	~StringArena();
+
+	const char* store(const char *str);
+	const char* intern(const char *str);
+	void absorb(StringArena& other);	// take over the strings of other
+	std::size_t bytes() const { return bytes_; }
+
+	// hash and equality on the string contents, for containers keyed by views
+	struct CStrHash {
+		std::size_t operator()(const char *str) const;
+	};
+	struct CStrEqual {
+		bool operator()(const char *lhs, const char *rhs) const;
+	};
+
+private:
+	typedef std::unordered_set<const char*, CStrHash, CStrEqual> Interned_;
+
+	const std::size_t blockSize_;
+	std::vector<char*> blocks_;
+	char *cur_;
+	std::size_t left_;
+	std::size_t bytes_;
+	Interned_ interned_;
+
+	char* allocate(std::size_t len);
+
+	// prevent generated functions
+	StringArena(const StringArena&);
+	StringArena& operator=(const StringArena&);
+};
+
+#endif /* STRINGARENA_H_ */
@@ -1,4 +1,5 @@
 #include "ThreadMgr.h"
+#include "Checkpoint.h"
 													   
 ShadowThread::ThreadId ThreadMgr::currentThreadId_ = 0;
 
@@ -21,4 +22,39 @@ void ThreadMgr::threadJoined(ThreadId threadId) {
 	if (search != tIdThreadMap_.end())
 		delete search->second;
 	tIdThreadMap_.erase(threadId);
-}
\ No newline at end of file
+}
+
+void ThreadMgr::serialize(rapidjson::Value& state,
+						  rapidjson::Document::AllocatorType& allocator) const {
+
+	rapidjson::Value mappings(rapidjson::kArrayType);
+	for (const auto& entry : tIdThreadMap_) {
+		rapidjson::Value mapping(rapidjson::kArrayType);
+		mapping.PushBack(entry.first, allocator);
+		mapping.PushBack(entry.second->threadId, allocator);
+		mappings.PushBack(mapping, allocator);
+	}
+
+	state.SetObject();
+	state.AddMember("next", ThreadMgr::currentThreadId_, allocator);
+	state.AddMember("mappings", mappings, allocator);
+}
+
+bool ThreadMgr::restore(const rapidjson::Value& state, ShadowIndex *index) {
+
+	if (!Checkpoint::hasArray(state, "mappings") || !state.HasMember("next") ||
+		!state["next"].IsUint())
+		return false;
+
+	const rapidjson::Value& mappings = state["mappings"];
+	for (rapidjson::SizeType i = 0; i < mappings.Size(); ++i) {
+		if (!Checkpoint::isTuple(mappings[i], 2) || !mappings[i][0u].IsUint() ||
+			!mappings[i][1u].IsUint())
+			return false;
+		ShadowThread *shadow = new ShadowThread(mappings[i][1u].GetUint());
+		tIdThreadMap_[mappings[i][0u].GetUint()] = shadow;
+		index->threads[shadow->threadId] = shadow;
+	}
+	ThreadMgr::currentThreadId_ = state["next"].GetUint();
+	return true;
+}
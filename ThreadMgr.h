@@ -12,6 +12,9 @@
 
 #include <map>
 #include "ShadowThread.h"
+#include "rapidjson/document.h"
+
+struct ShadowIndex;
 
 /******************************************************************************
  * ThreadMgr
@@ -24,6 +27,11 @@ public:
 	ShadowThread* getThread(ThreadId threadId);
 	void threadJoined(ThreadId threadId);
 
+	// checkpointing: thread mappings and the next shadow thread id
+	void serialize(rapidjson::Value& state,
+				   rapidjson::Document::AllocatorType& allocator) const;
+	bool restore(const rapidjson::Value& state, ShadowIndex *index);	// false if malformed
+
 private:
 	static ShadowThread::ThreadId currentThreadId_;
 	typedef std::map<ThreadId, ShadowThread*> TIdThreadMap_;
@@ -0,0 +1,38 @@
+/*
+ * Tool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "Tool.h"
+
+void Tool::onBatch(const EventBatch& batch) {
+
+	for (const auto& record : batch) {
+		switch (record.type) {
+		case NEWTHREAD:
+			threadCreated(record.thread, record.childThread);
+			break;
+		case JOIN:
+			threadJoined(record.thread, record.childThread);
+			break;
+		case ACQUIRE:
+			lockAcquired(record.thread, record.lock);
+			break;
+		case RELEASE:
+			lockReleased(record.thread, record.lock);
+			break;
+		case ACCESS:
+			varAccessed(record.thread, record.var,
+						static_cast<ShadowVar::VarType>(record.varType),
+						static_cast<Access::type>(record.accessType),
+						record.instruction);
+			break;
+		case CALL:
+			called(record.thread, batch.call(record));
+			break;
+		default:
+			break;
+		}
+	}
+}
@@ -8,7 +8,12 @@
 #ifndef OBSERVER_H_
 #define OBSERVER_H_
 
-class Event;
+#include "rapidjson/document.h"
+#include "Event.h"
+#include "ShadowLock.h"
+#include "ShadowVar.h"
+
+struct ShadowIndex;
 
 class Tool {
 public:
@@ -19,6 +24,30 @@ virtual void release(const Event* e) = 0;
 virtual void access(const Event* e) = 0;
 virtual void call(const Event* e) = 0;
 
+// a batch of event records (see EventService::setBatchSize). Only tools that
+// return true from batched() receive batches; the others keep receiving
+// their events one by one through the callbacks above, also in batch and
+// async mode. The default onBatch passes every record to its handler below.
+virtual bool batched() const { return false; }
+virtual void onBatch(const EventBatch& batch);
+
+// the event records by id
+virtual void threadCreated(ThreadId threadId, ThreadId childId) {}
+virtual void threadJoined(ThreadId threadId, ThreadId childId) {}
+virtual void lockAcquired(ThreadId threadId, ShadowLock::LockId lockId) {}
+virtual void lockReleased(ThreadId threadId, ShadowLock::LockId lockId) {}
+virtual void varAccessed(ThreadId threadId, RefId ref,
+						 ShadowVar::VarType varType, Access::type accessType,
+						 TraceId instruction) {}
+virtual void called(ThreadId threadId, const CallInfo& call) {}
+
+// checkpointing (see Checkpoint); stateless tools keep the defaults.
+// restore returns false if the state is malformed
+virtual void serialize(rapidjson::Value& state,
+					   rapidjson::Document::AllocatorType& allocator) const {}
+virtual bool restore(const rapidjson::Value& state,
+					 const ShadowIndex& shadows) { return true; }
+
 virtual ~Tool() {};
 };
 
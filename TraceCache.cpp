@@ -0,0 +1,174 @@
+/*
+ * TraceCache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "TraceCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <boost/log/trivial.hpp>
+#include "Interpreter.h"
+#include "DBDataModel.h"
+
+const char TraceCache::MAGIC[8] = { 'S', 'A', 'A', 'P', 'T', 'R', 'C', '\0' };
+const uint32_t TraceCache::VERSION;
+const uint8_t TraceCache::NO_TYPE;
+const uint32_t TraceCache::NO_STRING;
+
+int TraceCache::open(const char *path, const char *sourcePath) {
+
+	namespace ipc = boost::interprocess;
+
+	try {
+		file_ = ipc::file_mapping(path, ipc::read_only);
+		region_ = ipc::mapped_region(file_, ipc::read_only);
+	} catch (const ipc::interprocess_exception& e) {
+		BOOST_LOG_TRIVIAL(warning) << "Can't map " << path << " - error: "
+								 << e.what();
+		return IN_ABORT;
+	}
+
+	header_ = static_cast<const Header*>(region_.get_address());
+	if (region_.get_size() < sizeof(Header) ||
+		memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		header_->version != VERSION ||
+		header_->idSize != sizeof(INS_ID)) {
+		BOOST_LOG_TRIVIAL(error) << path << " is no trace cache of version "
+								 << VERSION;
+		header_ = nullptr;
+		return IN_ABORT;
+	}
+
+	for (unsigned i = 0; i < N_COLUMNS; ++i) {
+		if (header_->offset[i] + header_->count[i] * header_->width[i] >
+			region_.get_size()) {
+			BOOST_LOG_TRIVIAL(error) << path << " is truncated";
+			header_ = nullptr;
+			return IN_ABORT;
+		}
+	}
+
+	if (!validColumns()) {
+		BOOST_LOG_TRIVIAL(error) << path << " has inconsistent columns";
+		header_ = nullptr;
+		return IN_ABORT;
+	}
+
+	Source source;
+	if (sourcePath != nullptr &&
+		(identify(sourcePath, &source) != IN_OK ||
+		 memcmp(&source, &header_->source, sizeof(source)) != 0)) {
+		BOOST_LOG_TRIVIAL(warning) << path << " was not written from "
+								   << sourcePath << " as it is now";
+		header_ = nullptr;
+		return IN_ABORT;
+	}
+
+	BOOST_LOG_TRIVIAL(trace) << "successfully mapped " << path;
+	return IN_OK;
+}
+
+int TraceCache::identify(const char *path, Source *source) {
+
+	struct stat info;
+	if (stat(path, &info) != 0) {
+		BOOST_LOG_TRIVIAL(error) << "Can't stat " << path;
+		return IN_ABORT;
+	}
+
+	memset(source, 0, sizeof(*source));
+	source->device = info.st_dev;
+	source->inode = info.st_ino;
+	source->size = info.st_size;
+	source->mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+					info.st_mtim.tv_nsec;
+	return IN_OK;
+}
+
+// the interpreters index the columns without bounds checks
+bool TraceCache::validColumns() const {
+
+	static const uint64_t widths[N_COLUMNS] = {
+		sizeof(INS_ID), sizeof(uint8_t), sizeof(CAL_ID), sizeof(TRD_TID),
+		sizeof(ACC_ID), sizeof(ACC_ID), sizeof(REF_ID), sizeof(uint8_t),
+		sizeof(TRD_TID), sizeof(FUN_ID), sizeof(int32_t), sizeof(uint8_t),
+		sizeof(uint32_t), sizeof(FIL_ID), sizeof(uint32_t), sizeof(uint32_t),
+		sizeof(uint8_t), sizeof(REF_SIZE), sizeof(uint32_t), sizeof(char) };
+
+	for (unsigned i = 0; i < N_COLUMNS; ++i)
+		if (header_->width[i] != widths[i] || header_->offset[i] % 8 != 0)
+			return false;
+
+	// columns of one table have the same length
+	const uint64_t *count = header_->count;
+	if (count[INSTRUCTION_TYPE] != count[INSTRUCTION_ID] ||
+		count[INSTRUCTION_CALL] != count[INSTRUCTION_ID] ||
+		count[INSTRUCTION_CHILD] != count[INSTRUCTION_ID] ||
+		count[INSTRUCTION_ACCESSES] != count[INSTRUCTION_ID] + 1 ||
+		count[ACCESS_REFERENCE] != count[ACCESS_ID] ||
+		count[ACCESS_TYPE] != count[ACCESS_ID] ||
+		count[CALL_FUNCTION] != count[CALL_THREAD] ||
+		count[CALL_RUNTIME] != count[CALL_THREAD] ||
+		count[FUNCTION_SIGNATURE] != count[FUNCTION_TYPE] ||
+		count[FUNCTION_FILE] != count[FUNCTION_TYPE] ||
+		count[FILE_PATH] != count[FILE_NAME] ||
+		count[REFERENCE_SIZE] != count[REFERENCE_TYPE] ||
+		count[REFERENCE_NAME] != count[REFERENCE_TYPE])
+		return false;
+
+	// the access slices ascend within the access columns
+	const ACC_ID *slices = column<ACC_ID>(INSTRUCTION_ACCESSES);
+	for (uint64_t i = 0; i < count[INSTRUCTION_ID]; ++i)
+		if (slices[i] > slices[i + 1])
+			return false;
+	return slices[0] == 0 && slices[count[INSTRUCTION_ID]] == count[ACCESS_ID];
+}
+
+TraceCacheWriter::TraceCacheWriter(const char *path,
+								   const TraceCache::Source& source)
+	: path_(path), tmpPath_(path_ + ".tmp"),
+	  out_(tmpPath_.c_str(), std::ios::binary | std::ios::trunc) {
+
+	// placeholder without magic, rewritten by close()
+	memset(&header_, 0, sizeof(header_));
+	out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+
+	memcpy(header_.magic, TraceCache::MAGIC, sizeof(header_.magic));
+	header_.version = TraceCache::VERSION;
+	header_.idSize = sizeof(INS_ID);
+	header_.source = source;
+}
+
+void TraceCacheWriter::write(TraceCache::Column column, const void *data,
+							 std::size_t size, std::size_t count) {
+
+	static const char padding[8] = { 0 };
+
+	std::streamoff pos = out_.tellp();
+	if (pos % 8 != 0) {
+		out_.write(padding, 8 - pos % 8);
+		pos = out_.tellp();
+	}
+
+	header_.offset[column] = pos;
+	header_.count[column] = count;
+	header_.width[column] = size;
+	out_.write(static_cast<const char*>(data), size * count);
+}
+
+int TraceCacheWriter::close() {
+
+	out_.seekp(0);
+	out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+	out_.close();
+
+	if (out_.fail() || std::rename(tmpPath_.c_str(), path_.c_str()) != 0) {
+		BOOST_LOG_TRIVIAL(error) << "Can't write trace cache " << path_;
+		std::remove(tmpPath_.c_str());
+		return IN_ABORT;
+	}
+	return IN_OK;
+}
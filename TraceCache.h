@@ -0,0 +1,139 @@
+/*
+ * TraceCache.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef TRACECACHE_H_
+#define TRACECACHE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/******************************************************************************
+ * TraceCache
+ *
+ * Binary, columnar image of a loaded and linked trace. Every column is a
+ * fixed-width array (native byte order, 8-byte aligned) and all text
+ * lives in one string heap, so a cache file can be mapped and used in
+ * place. Instructions are stored in interpretation order; their accesses
+ * form a CSR slice (INSTRUCTION_ACCESSES holds n + 1 offsets). Functions,
+ * files and references are indexed by their id, with NO_ID32 / NO_TYPE /
+ * NO_STRING marking ids without a row. The header records the identity of
+ * the database the cache was written from (see Source), so a cache is not
+ * taken for a database that was replaced or changed since.
+ *****************************************************************************/
+class TraceCache {
+public:
+	static const char MAGIC[8];
+	static const uint32_t VERSION = 2;
+	static const uint8_t NO_TYPE = 0xFF;
+	static const uint32_t NO_STRING = 0xFFFFFFFF;	// heap offset of no text
+
+	typedef enum { INSTRUCTION_ID,		// INS_ID
+				   INSTRUCTION_TYPE,	// uint8_t (Instruction::type)
+				   INSTRUCTION_CALL,	// CAL_ID of the segment's call
+				   INSTRUCTION_CHILD,	// TRD_TID of fork/join child
+				   INSTRUCTION_ACCESSES,// ACC_ID CSR offsets
+				   ACCESS_ID,			// ACC_ID
+				   ACCESS_REFERENCE,	// REF_ID
+				   ACCESS_TYPE,			// uint8_t (Access::type)
+				   CALL_THREAD,			// TRD_TID
+				   CALL_FUNCTION,		// FUN_ID
+				   CALL_RUNTIME,		// int32_t
+				   FUNCTION_TYPE,		// uint8_t (Function::type)
+				   FUNCTION_SIGNATURE,	// uint32_t heap offset
+				   FUNCTION_FILE,		// FIL_ID
+				   FILE_NAME,			// uint32_t heap offset
+				   FILE_PATH,			// uint32_t heap offset
+				   REFERENCE_TYPE,		// uint8_t (ShadowVar::VarType)
+				   REFERENCE_SIZE,		// REF_SIZE
+				   REFERENCE_NAME,		// uint32_t heap offset
+				   STRING_HEAP,			// char
+				   N_COLUMNS
+				 } Column;
+
+	// the database file, as far as stat(2) tells it apart
+	struct Source {
+		uint64_t device;
+		uint64_t inode;
+		uint64_t size;
+		int64_t mtime;				// nanoseconds since the epoch
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t idSize;			// sizeof(INS_ID) of the writer
+		Source source;
+		uint64_t offset[N_COLUMNS];	// byte offset of every column
+		uint64_t count[N_COLUMNS];	// element count of every column
+		uint64_t width[N_COLUMNS];	// element size of every column
+	};
+
+	TraceCache() : header_(nullptr) {}
+
+	// with a sourcePath, only a cache written from that database is valid
+	int open(const char *path, const char *sourcePath = nullptr);
+	static int identify(const char *path, Source *source);
+	uint64_t count(Column column) const { return header_->count[column]; }
+
+	template<typename T>
+	const T* column(Column column) const {
+		return reinterpret_cast<const T*>(
+			static_cast<const char*>(region_.get_address()) +
+			header_->offset[column]);
+	}
+
+	const char* string(uint32_t offset) const {
+		return column<char>(STRING_HEAP) + offset;
+	}
+
+private:
+	boost::interprocess::file_mapping file_;
+	boost::interprocess::mapped_region region_;
+	const Header *header_;
+
+	bool validColumns() const;
+
+	// prevent generated functions
+	TraceCache(const TraceCache&);
+	TraceCache& operator=(const TraceCache&);
+};
+
+/******************************************************************************
+ * TraceCacheWriter
+ *
+ * Writes next to the cache file and only renames the result into place
+ * once close() succeeded, so an interrupted or failed write never leaves a
+ * cache behind that TraceCache::open would accept.
+ *****************************************************************************/
+class TraceCacheWriter {
+public:
+	TraceCacheWriter(const char *path, const TraceCache::Source& source);
+
+	template<typename T>
+	void write(TraceCache::Column column, const std::vector<T>& data) {
+		write(column, data.data(), sizeof(T), data.size());
+	}
+	int close();
+
+private:
+	std::string path_;
+	std::string tmpPath_;
+	std::ofstream out_;
+	TraceCache::Header header_;
+
+	void write(TraceCache::Column column, const void *data,
+			   std::size_t size, std::size_t count);
+
+	// prevent generated functions
+	TraceCacheWriter(const TraceCacheWriter&);
+	TraceCacheWriter& operator=(const TraceCacheWriter&);
+};
+
+#endif /* TRACECACHE_H_ */
@@ -5,48 +5,182 @@
  *      Author: wilhelma
  */
 
+#include <cstring>
+#include <cstdlib>
+#include <vector>
 #include <boost/log/trivial.hpp>
 #include "SAAPRunner.h"
-#include "EventService.h"
+#include "StaticEventService.h"
+#include "Filter.h"
+#include "ShadowVar.h"
 #include "DBInterpreter.h"
+#include "MmapInterpreter.h"
+#include "TraceCache.h"
 #include "RaceDetectionTool.h"
 #include "LockSetChecker.h"
 #include "LockMgr.h"
 #include "ThreadMgr.h"
+#include "RunReport.h"
 
 
 int main(int argc, char* argv[]) {
 
 	// check arguments
-	if (argc < 2) {
+	const char *dbPath = nullptr;
+	std::vector<const char*> shardPaths;	// further databases of the trace
+	bool disjointShards = false;			// one shard per process
+	const char *cachePath = nullptr;
+	const char *checkpointPath = nullptr;
+	const char *reportPath = nullptr;
+	unsigned checkpointInterval = 1000000;
+	bool resume = false;
+	DBInterpreter::Mode mode = DBInterpreter::LOAD;
+	DBInterpreter::TailProfile tail = DBInterpreter::TailProfile::defaults();
+	size_t spillBudget = 1024;	// MiB
+	const char *spillDirectory = "/tmp";
+	bool async = false;
+	EventService::AsyncProfile asyncProfile = EventService::AsyncProfile::defaults();
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--stream") == 0)
+			mode = DBInterpreter::STREAM;
+		else if (strcmp(argv[i], "--tail") == 0)
+			mode = DBInterpreter::TAIL;
+		else if (strcmp(argv[i], "--external") == 0)
+			mode = DBInterpreter::EXTERNAL;
+		else if (strcmp(argv[i], "--spill-budget") == 0 && i + 1 < argc)
+			spillBudget = strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--spill-dir") == 0 && i + 1 < argc)
+			spillDirectory = argv[++i];
+		else if (strcmp(argv[i], "--tail-batch") == 0 && i + 1 < argc)
+			tail.batchSize = strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--tail-timeout") == 0 && i + 1 < argc)
+			tail.idleTimeout = strtoul(argv[++i], nullptr, 10) * 1000;
+		else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+			cachePath = argv[++i];
+		else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+			checkpointPath = argv[++i];
+		else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc)
+			checkpointInterval = strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+			reportPath = argv[++i];
+		else if (strcmp(argv[i], "--resume") == 0)
+			resume = true;
+		else if (strcmp(argv[i], "--disjoint-shards") == 0)
+			disjointShards = true;
+		else if (strcmp(argv[i], "--async") == 0)
+			async = true;
+		else if (strcmp(argv[i], "--async-capacity") == 0 && i + 1 < argc)
+			asyncProfile.capacity = strtoul(argv[++i], nullptr, 10);
+		else if (dbPath == nullptr)
+			dbPath = argv[i];
+		else
+			shardPaths.push_back(argv[i]);
+	}
+
+	// the trace cache is read and written in LOAD mode of a single database
+	if (cachePath != nullptr &&
+		(mode != DBInterpreter::LOAD || !shardPaths.empty())) {
+		BOOST_LOG_TRIVIAL(warning) << "Ignoring the trace cache " << cachePath
+								   << ", it is only used in LOAD mode of a"
+								   << " single database";
+		cachePath = nullptr;
+	}
+
+	// a valid trace cache of the database replaces it
+	bool useCache = false;
+	if (cachePath != nullptr) {
+		TraceCache cache;
+		useCache = cache.open(cachePath, dbPath) == IN_OK;
+	}
+
+	if (dbPath == nullptr && !useCache) {
 		BOOST_LOG_TRIVIAL(fatal) << "No database name provided!";
 		return 1;
 	}
 
+	if (mode == DBInterpreter::TAIL && tail.batchSize == 0) {
+		BOOST_LOG_TRIVIAL(fatal) << "Tailing needs a positive batch size!";
+		return 1;
+	}
+
+	if (checkpointInterval == 0 || (resume && checkpointPath == nullptr)) {
+		BOOST_LOG_TRIVIAL(fatal) << "Resuming needs a checkpoint file and a"
+								 << " positive checkpoint interval!";
+		return 1;
+	}
+
+	// create the tools; alone, the checker is dispatched to statically. With
+	// --async the vector clock detector joins it and both run on threads of
+	// their own (see EventService::startAsync).
+	LockSetChecker *raceTool = new LockSetChecker("races.json");
+	RaceDetectionTool *vcTool =
+		async ? new RaceDetectionTool("vc-races.json") : nullptr;
+	Filter raceFilter;	// the tools ignore stack variables anyway
+	raceFilter.excludeMemoryTypes(ShadowVar::STACK);
+	const int raceEvents = NEWTHREAD | JOIN | ACQUIRE | RELEASE | ACCESS;
+	typedef Subscription<LockSetChecker, raceEvents> RaceSub;
+
 	// create interpreter, event service, and saap runner
-	EventService *service = new EventService();
+	EventService *service;
+	if (async) {
+		service = new EventService();
+		service->subscribe(raceTool, &raceFilter, static_cast<Events>(raceEvents));
+		service->subscribe(vcTool, &raceFilter, static_cast<Events>(raceEvents));
+		service->startAsync(asyncProfile);
+	} else {
+		service = new StaticEventService<RaceSub>(RaceSub(raceTool, &raceFilter));
+	}
 	LockMgr *lockMgr = new LockMgr();
 	ThreadMgr *threadMgr = new ThreadMgr();
-	DBInterpreter *interpreter = new DBInterpreter(argv[1],
-												   "SAAP.log",
-												   service,
-												   lockMgr,
-												   threadMgr);
+	Interpreter *interpreter;
+	if (useCache) {
+		MmapInterpreter *mmapInterpreter = new MmapInterpreter(cachePath,
+															   "SAAP.log",
+															   service,
+															   lockMgr,
+															   threadMgr);
+		if (dbPath != nullptr)
+			mmapInterpreter->setSource(dbPath);
+		interpreter = mmapInterpreter;
+	} else {
+		DBInterpreter *dbInterpreter = new DBInterpreter(dbPath,
+														 "SAAP.log",
+														 service,
+														 lockMgr,
+														 threadMgr,
+														 mode);
+		if (cachePath != nullptr)
+			dbInterpreter->setCacheFile(cachePath);
+		dbInterpreter->setTailProfile(tail);
+		dbInterpreter->setSpillBudget(spillBudget * 1024 * 1024, spillDirectory);
+		for (auto shardPath : shardPaths)
+			dbInterpreter->addShard(shardPath);
+		dbInterpreter->setDisjointShards(disjointShards);
+		interpreter = dbInterpreter;
+	}
+	if (checkpointPath != nullptr)
+		interpreter->setCheckpoint(checkpointPath, checkpointInterval, resume);
+	RunReport report;
+	if (reportPath != nullptr)
+		interpreter->setReport(&report);
 	
 	SAAPRunner *runner = new SAAPRunner(interpreter);
 
-	// create and register tools
-	//RaceDetectionTool *raceTool = new RaceDetectionTool("races.json");
-	LockSetChecker *raceTool = new LockSetChecker("races.json");
-	runner->registerTool(raceTool, NULL, ALL);
-
 	// Start interpretation
 	runner->interpret();
 
 	delete interpreter;
 	delete service;
 	delete runner;
+
+	// the tools write their races when they are destroyed
+	RunReport::Mark dumped = RunReport::now();
 	delete raceTool;
+	delete vcTool;
+	if (reportPath != nullptr) {
+		report.phase("dump", dumped, 0);
+		report.write(reportPath);
+	}
 
 	return 0;
 }